@@ -1,4 +1,8 @@
 #pragma once
 
+#include "CrossValidation.h"
+#include "ElasticNet.h"
 #include "LinReg.h"
-#include "LogReg.h"
\ No newline at end of file
+#include "LogReg.h"
+#include "RowView.h"
+#include "StandardScaler.h"
\ No newline at end of file
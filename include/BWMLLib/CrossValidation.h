@@ -0,0 +1,92 @@
+#pragma once
+
+#include "LinReg.h"
+#include "NDArray.hpp"
+#include "RowView.h"
+#include <cstdint>
+#include <vector>
+
+namespace BWMLLib {
+	/*
+		K-fold splitter: the rows (optionally shuffled) are cut into n_splits contiguous folds of (almost) equal
+		size, each fold is the test set once and the other folds are its training set.
+
+		A split is a single row order shared by all folds, every fold's train / test rows are RowViews into it,
+		so splitting costs one index per row no matter how many folds there are.
+	*/
+	class KFold {
+
+	private:
+		size_t n_splits;
+		bool shuffle;
+		uint64_t seed;
+
+	public:
+		/*
+			Params:
+				n_splits: the number of folds, at least 2.
+				shuffle: whether the rows are shuffled before they are cut into folds.
+				seed: the seed of the shuffle, the same seed gives the same folds.
+		*/
+		KFold(size_t n_splits = 5, bool shuffle = false, uint64_t seed = 0);
+
+		std::vector<size_t> row_order(size_t n_samples) const;
+
+		size_t fold_begin(size_t fold, size_t n_samples) const;
+
+		size_t fold_end(size_t fold, size_t n_samples) const;
+
+		RowView train_rows(const std::vector<size_t>& order, size_t fold) const;
+
+		RowView test_rows(const std::vector<size_t>& order, size_t fold) const;
+
+		size_t get_n_splits() const;
+	};
+
+	/*
+		The outcome of training on one fold.
+	*/
+	struct FoldScore {
+		size_t fold = 0;
+		size_t n_train = 0;
+		size_t n_test = 0;
+		double train_cost = 0.0; // mean squared error over the training rows.
+		double test_cost = 0.0;  // mean squared error over the held-out rows.
+		NDArray<double> weights;
+		double bias = 0.0;
+	};
+
+	struct CrossValidationResult {
+		std::vector<FoldScore> folds;
+		double mean_test_cost = 0.0;
+		double std_test_cost = 0.0;
+	};
+
+	/*
+		K-fold cross-validation of several candidate models over one shared dataset.
+
+		Every (candidate, fold) pair is an independent task: a copy of the candidate is trained on the fold's
+		training rows and scored on its test rows. The tasks are spread over the cores by the NDParallel pool.
+		Each model reads X / y in place through its fold's RowViews, so the memory used is one dataset plus one
+		row order plus the models, independent of the number of folds and candidates. The data-parallel loops
+		inside each fit run serially on the worker that owns the task, so the cores are not oversubscribed.
+
+		Each task trains with the candidate's own thread count setting as its number of shards (a setting of 0 is
+		resolved to NDParallel::get_num_threads() of the calling thread, once), which is what fixes its floating
+		point results: they do not depend on which threads the tasks are scheduled on.
+
+		Params:
+			candidates: the (untrained) model configurations to evaluate.
+			X: the features, of shape (n_samples, n_features).
+			y: the targets, one per row of X.
+			folds: the splitter.
+			iterations: the maximum number of gradient descent iterations per fit.
+
+		Returns one result per candidate, in the order of the candidates.
+	*/
+	std::vector<CrossValidationResult> cross_validate(const std::vector<LinReg>& candidates, const NDArray<double>& X,
+		const NDArray<double>& y, const KFold& folds, size_t iterations);
+
+	CrossValidationResult cross_validate(const LinReg& model, const NDArray<double>& X, const NDArray<double>& y,
+		const KFold& folds, size_t iterations);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "NDArray.hpp"
+#include <vector>
+
+namespace BWMLLib {
+	/*
+		Linear regression with combined L1 / L2 regularization, minimizing
+
+			1 / (2m) * ||y - X w - b||^2 + alpha * l1_ratio * ||w||_1 + alpha * (1 - l1_ratio) / 2 * ||w||^2
+
+		l1_ratio = 0 is Ridge regression, l1_ratio = 1 is the Lasso (see the Ridge / Lasso classes below).
+
+		The solvers never touch X after a single pass over it: precompute() reduces X / y to the (centered) Gram
+		matrix X^T X / m and X^T y / m, and every fit afterwards works on those n_features x n_features numbers only:
+			- pure L2: a Cholesky solve of (X^T X / m + alpha I) w = X^T y / m.
+			- with L1: covariance-based coordinate descent, warm-started from the previous solution of the path.
+		So sweeping a whole grid of alphas costs one pass over the data plus a row-count independent amount of work.
+	*/
+	class ElasticNet {
+
+	public:
+		/*
+			Coefficients of a fit over a list of regularization strengths, in the order the alphas were given.
+		*/
+		struct RegularizationPath {
+			std::vector<double> alphas;
+			std::vector<NDArray<double>> weights;
+			std::vector<double> biases;
+		};
+
+	private:
+		double alpha;
+		double l1_ratio;
+		double tol;
+		size_t max_iter;
+		NDArray<double> weights;
+		NDArray<double> biases;
+
+		// The cached single pass over the training data.
+		size_t n_samples;
+		size_t n_features;
+		std::vector<double> x_mean;
+		double y_mean;
+		std::vector<double> gram; // centered X^T X / m, row-major n_features x n_features.
+		std::vector<double> xty;  // centered X^T y / m.
+
+		/*
+			Per-block running statistics used to build the Gram matrix: means and co-moments (sums of products of
+			deviations from the mean), merged across blocks with Chan's formula.
+		*/
+		struct CoMoments {
+			size_t count = 0;
+			std::vector<double> x_mean;
+			double y_mean = 0.0;
+			std::vector<double> cxx; // upper triangle, packed row by row.
+			std::vector<double> cxy;
+		};
+
+		// precompute() cuts the rows into blocks of at least min_block_rows rows, at most max_blocks of them. The
+		// blocks only depend on the number of rows, so the result does not depend on the thread count. Each block's
+		// CoMoments holds n_features * (n_features + 1) / 2 doubles, and NDParallel::parallel_reduce keeps at most
+		// (# threads + log2(# blocks)) of them alive at a time.
+		static constexpr size_t min_block_rows = 4096;
+		static constexpr size_t max_blocks = 64;
+
+		static size_t packed_row(size_t j, size_t n_features);
+
+		static CoMoments compute_comoments(const double* X, const double* y, size_t row_begin, size_t row_end, size_t n_features);
+
+		static CoMoments merge(const CoMoments& a, const CoMoments& b);
+
+		void solve_ridge(double alpha, std::vector<double>& w) const;
+
+		void solve_coordinate_descent(double alpha, std::vector<double>& w) const;
+
+		double intercept(const std::vector<double>& w) const;
+
+	public:
+		/*
+			Params:
+				alpha: the overall regularization strength.
+				l1_ratio: the share of the L1 penalty, in [0, 1].
+				tol: coordinate descent stops once no coefficient moved by more than tol in a full sweep.
+				max_iter: the maximum number of coordinate descent sweeps per alpha.
+		*/
+		ElasticNet(double alpha = 1.0, double l1_ratio = 0.5, double tol = 1e-8, size_t max_iter = 10000);
+
+		void precompute(const NDArray<double>& X, const NDArray<double>& y);
+
+		bool is_precomputed() const;
+
+		void fit(const NDArray<double>& X, const NDArray<double>& y);
+
+		void fit();
+
+		RegularizationPath fit_path(const NDArray<double>& X, const NDArray<double>& y, const std::vector<double>& alphas);
+
+		RegularizationPath fit_path(const std::vector<double>& alphas);
+
+		NDArray<double> predict(const NDArray<double>& X) const;
+
+		void set_alpha(double alpha);
+
+		double get_alpha() const;
+
+		const NDArray<double>& get_weights() const;
+
+		const NDArray<double>& get_biases() const;
+	};
+
+	/*
+		L2-regularized linear regression, solved by Cholesky factorization of the cached Gram matrix.
+	*/
+	class Ridge : public ElasticNet {
+	public:
+		Ridge(double alpha = 1.0) : ElasticNet(alpha, 0.0) {}
+	};
+
+	/*
+		L1-regularized linear regression, solved by coordinate descent on the cached Gram matrix.
+	*/
+	class Lasso : public ElasticNet {
+	public:
+		Lasso(double alpha = 1.0, double tol = 1e-8, size_t max_iter = 10000) : ElasticNet(alpha, 1.0, tol, max_iter) {}
+	};
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "NDArray.hpp"
+#include "RowView.h"
 #include <cmath>
+#include <vector>
 
 namespace BWMLLib {
 	class LinReg {
@@ -9,6 +11,8 @@ namespace BWMLLib {
 	private:
 		double learning_rate;
 		double convergence_tol;
+		size_t n_threads;
+		bool verbose;
 		NDArray<double> weights;
 		NDArray<double> biases;
 		NDArray<double> X;
@@ -16,19 +20,67 @@ namespace BWMLLib {
 		NDArray<double> dw;
 		NDArray<double> db;
 
+		/*
+			Partial gradient & cost accumulated by one worker over its shard of rows.
+			Each worker owns exactly one of these, so no two threads ever write to the same buffer.
+		*/
+		struct ShardGradient {
+			std::vector<double> dw;
+			double db = 0.0;
+			double cost = 0.0;
+		};
+
+		void accumulate_shard(const double* x, const double* t, const RowView& rows, size_t row_begin, size_t row_end, ShardGradient& out) const;
+
+		static void tree_reduce(std::vector<ShardGradient>& partials);
+
+		size_t resolve_num_threads(size_t n_rows) const;
+
+		static size_t validate_data(const NDArray<double>& X, const NDArray<double>& y);
+
+		void train(const double* x, const double* t, size_t n, const RowView& rows, size_t iterations);
+
 	public:
-		LinReg(double learning_rate, double convergence_tol = 1e-6);
+		/*
+			Params:
+				learning_rate: the step size of gradient descent.
+				convergence_tol: training stops once the change of the cost between two iterations falls below this value.
+				n_threads: the number of row shards (and threads) used by fit(), 0 means the library-wide NDParallel thread count.
+		*/
+		LinReg(double learning_rate, double convergence_tol = 1e-6, size_t n_threads = 1);
 
 		void initialize_parameters(int n_features);
 
+		void set_num_threads(size_t n_threads);
+
+		size_t get_num_threads() const;
+
+		void set_verbose(bool verbose);
+
 		NDArray<double> forward(const NDArray<double>& X) const;
 
+		/*
+			compute_cost(predictions) and backward() work against the X / y taken over by the last fit(X, y, iterations).
+			A model that holds no data (never fitted, or last fitted on a RowView) throws std::logic_error.
+		*/
 		double compute_cost(NDArray<double> predictions) const;
 
+		double compute_cost(const NDArray<double>& X, const NDArray<double>& y, const RowView& rows) const;
+
 		void backward(const NDArray<double> predictions);
 
 		void fit(NDArray<double>& X, NDArray<double>& y, size_t iterations);
 
+		/*
+			Trains on the selected rows of X / y, read in place. Neither is retained, and the data of any previous
+			fit(X, y, iterations) is released.
+		*/
+		void fit(const NDArray<double>& X, const NDArray<double>& y, const RowView& rows, size_t iterations);
+
 		NDArray<double> predict(NDArray<double> &X) const;
+
+		const NDArray<double>& get_weights() const;
+
+		const NDArray<double>& get_biases() const;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace BWMLLib {
+	/*
+		A read-only selection of the rows of a dataset, by index. Models train on a RowView instead of a copy of
+		the selected rows, so any number of folds / models can share one dataset.
+
+		The selection is a slice [offset, offset + size) of a row order (the identity if there is none), with an
+		optional hole cut out of it. That covers both sides of a k-fold split in O(1) memory each:
+			- the test rows of a fold: RowView::slice(order, begin, end)
+			- its training rows: RowView::excluding(order, begin, end)
+
+		A RowView does not own the order vector, which has to outlive it.
+	*/
+	class RowView {
+
+	private:
+		const size_t* order = nullptr;
+		size_t offset = 0;
+		size_t n_rows = 0;
+		size_t hole_begin = 0;
+		size_t hole_size = 0;
+
+	public:
+		/*
+			All the rows 0 ... n_rows - 1, in order.
+		*/
+		explicit RowView(size_t n_rows) : n_rows(n_rows) {}
+
+		/*
+			The rows listed in `rows`, in that order.
+		*/
+		explicit RowView(const std::vector<size_t>& rows) : order(rows.data()), n_rows(rows.size()) {}
+
+		/*
+			The rows order[begin] ... order[end - 1].
+		*/
+		static RowView slice(const std::vector<size_t>& order, size_t begin, size_t end) {
+			if (begin > end || end > order.size()) {
+				throw std::out_of_range("The slice must lie within the row order!");
+			}
+			RowView res(order);
+			res.offset = begin;
+			res.n_rows = end - begin;
+			return res;
+		}
+
+		/*
+			Every row of `order` except order[begin] ... order[end - 1].
+		*/
+		static RowView excluding(const std::vector<size_t>& order, size_t begin, size_t end) {
+			if (begin > end || end > order.size()) {
+				throw std::out_of_range("The excluded slice must lie within the row order!");
+			}
+			RowView res(order);
+			res.n_rows = order.size() - (end - begin);
+			res.hole_begin = begin;
+			res.hole_size = end - begin;
+			return res;
+		}
+
+		size_t size() const {
+			return this->n_rows;
+		}
+
+		/*
+			Returns the index (in the dataset) of the i-th selected row.
+		*/
+		size_t operator[](size_t i) const {
+			size_t position = this->offset + i + (i >= this->hole_begin ? this->hole_size : 0);
+			return this->order ? this->order[position] : position;
+		}
+
+		/*
+			The largest row index selected + 1, i.e. the minimum number of rows the dataset must have.
+		*/
+		size_t max_row_bound() const {
+			size_t bound = 0;
+			for (size_t i = 0; i < this->n_rows; ++i) {
+				bound = std::max(bound, (*this)[i] + 1);
+			}
+			return bound;
+		}
+	};
+}
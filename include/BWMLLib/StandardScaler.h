@@ -0,0 +1,74 @@
+#pragma once
+
+#include "NDArray.hpp"
+#include <vector>
+
+namespace BWMLLib {
+	/*
+		Standardizes features to zero mean and unit variance: x' = (x - mean) / std, per column.
+
+		The statistics are gathered in a single read of the data: every block of rows gets its own Welford
+		running mean / sum of squared deviations, and the blocks are merged with Chan's parallel formula.
+		partial_fit() merges one more chunk into the running statistics the same way, so the data can be
+		standardized while it is being loaded, without ever holding all of it in memory.
+	*/
+	class StandardScaler {
+
+	private:
+		bool with_mean;
+		bool with_std;
+		size_t n_samples_seen;
+		NDArray<double> mean;
+		NDArray<double> variance;
+		NDArray<double> scale;
+
+		/*
+			Running statistics of a set of rows: count, per-feature mean and per-feature sum of squared
+			deviations from the mean (M2, variance = M2 / count).
+		*/
+		struct Moments {
+			size_t count = 0;
+			std::vector<double> mean;
+			std::vector<double> m2;
+		};
+
+		// partial_fit() reduces blocks of at least min_block_rows rows, at most max_blocks of them. The blocks only
+		// depend on the number of rows, so the result does not depend on the thread count.
+		static constexpr size_t min_block_rows = 4096;
+		static constexpr size_t max_blocks = 64;
+
+		static Moments compute_moments(const double* X, size_t row_begin, size_t row_end, size_t n_features);
+
+		static Moments merge(const Moments& a, const Moments& b);
+
+		static size_t n_features_of(const NDArray<double>& X);
+
+	public:
+		/*
+			Params:
+				with_mean: whether transform() subtracts the mean.
+				with_std: whether transform() divides by the standard deviation.
+		*/
+		StandardScaler(bool with_mean = true, bool with_std = true);
+
+		void reset();
+
+		void fit(const NDArray<double>& X);
+
+		void partial_fit(const NDArray<double>& X);
+
+		void transform(NDArray<double>& X) const;
+
+		void fit_transform(NDArray<double>& X);
+
+		void inverse_transform(NDArray<double>& X) const;
+
+		const NDArray<double>& get_mean() const;
+
+		const NDArray<double>& get_variance() const;
+
+		const NDArray<double>& get_scale() const;
+
+		size_t get_n_samples_seen() const;
+	};
+}
@@ -0,0 +1,681 @@
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<cctype>
+#include<deque>
+#include<limits>
+#include<memory>
+#include<mutex>
+#include<optional>
+#include<stdexcept>
+#include<string>
+#include<unordered_map>
+#include<vector>
+#include "NDArray.hpp"
+#include "NDIter.hpp"
+#include "ThreadPool.hpp"
+
+/*
+	NDEinsum evaluates Einstein summation expressions over NDArrays, e.g.
+
+		NDEinsum::einsum("bij,bjk->bik", A, B)     batched matmul
+		NDEinsum::einsum("ij,jk,kl->il", A, B, C)   a matrix chain
+		NDEinsum::einsum("ii->", A)                 the trace (a 0-d result is returned with shape {1})
+
+	An expression is evaluated in three stages, all decided up front by a Plan that only depends on the spec and
+	the operand shapes (and is therefore cached, see PlanCache):
+		1. Each operand is prepared on its own: repeated labels become diagonals and labels used nowhere else are
+		   summed out, with one strided Gather.
+		2. The operands are contracted two at a time. The pair to contract next is picked greedily by the number of
+		   multiply-adds it costs (ties broken by the size of its result), so chains are evaluated cheap-end first.
+		   Each pairwise contraction is one call of NDArray's batched GEMM kernel: the labels are grouped into
+		   batch x rows x contracted, and when each group is a contiguous run of an operand's axes the kernel
+		   reads the operand in place through strides. Only operands whose layout cannot be expressed that way
+		   are gathered into a temporary first.
+		3. The result is permuted into the requested output order, if it is not in that order already.
+*/
+namespace NDEinsum {
+
+	/*
+		Builds a dense array out of a strided source:
+			dst[i_0, ..., i_r] = sum over j of src[i_0 * strides[0] + ... + j_0 * reduce_strides[0] + ...]
+		This covers everything done to a single operand: permuting axes, taking diagonals (a repeated label is one
+		axis whose stride is the sum of the label's strides) and summing labels out.
+	*/
+	struct Gather {
+		std::vector<size_t> shape;
+		std::vector<size_t> strides;
+		std::vector<size_t> reduce_shape;
+		std::vector<size_t> reduce_strides;
+	};
+
+	/*
+		How the GEMM kernel reads one operand of a contraction: as `batch` matrices, straight out of the operand's
+		buffer through the strides, or out of the operand gathered into a temporary first.
+	*/
+	struct OperandView {
+		std::optional<Gather> gather;
+		size_t batch_stride = 0;
+		size_t row_stride = 0;
+		size_t col_stride = 0;
+	};
+
+	/*
+		One pairwise contraction: (batch x M x K) @ (batch x K x N) -> (batch x M x N).
+	*/
+	struct Step {
+		// Indices into the working list, i.e. the prepared operands followed by the results of the previous steps.
+		size_t lhs = 0;
+		size_t rhs = 0;
+		OperandView a;
+		OperandView b;
+		size_t batch = 1;
+		size_t M = 1;
+		size_t N = 1;
+		size_t K = 1;
+		std::vector<size_t> result_shape;
+		double flops = 0.0; // # of multiply-adds.
+	};
+
+	struct Plan {
+		std::vector<std::optional<Gather>> prepare; // one per operand.
+		std::vector<Step> steps;
+		std::optional<Gather> finish;
+		std::vector<size_t> output_shape;
+		double flops = 0.0;
+	};
+
+	namespace detail {
+		/*
+			An operand (or intermediate result) during planning: one label per axis, stored densely.
+		*/
+		struct Term {
+			std::string labels;
+			std::vector<size_t> shape;
+
+			std::vector<size_t> strides() const {
+				std::vector<size_t> res(shape.size());
+				size_t stride = 1;
+				for (size_t d = shape.size(); d-- > 0;) {
+					res[d] = stride;
+					stride *= shape[d];
+				}
+				return res;
+			}
+
+			size_t size() const {
+				size_t res = 1;
+				for (size_t dim : shape) {
+					res *= dim;
+				}
+				return res;
+			}
+		};
+
+		inline std::string subtract(const std::string& labels, const std::string& removed) {
+			std::string res;
+			for (char label : labels) {
+				if (removed.find(label) == std::string::npos) {
+					res += label;
+				}
+			}
+			return res;
+		}
+
+		inline std::string intersect(const std::string& labels, const std::string& kept) {
+			std::string res;
+			for (char label : labels) {
+				if (kept.find(label) != std::string::npos) {
+					res += label;
+				}
+			}
+			return res;
+		}
+
+		/*
+			Splits "ij,jk->ik" into {"ij", "jk"} and "ik". Without "->" the output is every label that appears
+			exactly once, in alphabetical order (the numpy convention).
+		*/
+		inline void parse(const std::string& spec, size_t n_operands, std::vector<std::string>& inputs, std::string& output) {
+			std::string compact;
+			for (char c : spec) {
+				if (c != ' ') {
+					compact += c;
+				}
+			}
+
+			size_t arrow = compact.find("->");
+			std::string lhs = compact.substr(0, arrow);
+			inputs.clear();
+			size_t begin = 0;
+			while (true) {
+				size_t comma = lhs.find(',', begin);
+				inputs.push_back(lhs.substr(begin, comma - begin));
+				if (comma == std::string::npos) {
+					break;
+				}
+				begin = comma + 1;
+			}
+			if (inputs.size() != n_operands) {
+				throw std::invalid_argument("The number of operands does not match the einsum spec!");
+			}
+			for (const std::string& input : inputs) {
+				for (char label : input) {
+					if (!std::isalpha(static_cast<unsigned char>(label))) {
+						throw std::invalid_argument("einsum subscripts must be letters!");
+					}
+				}
+			}
+
+			if (arrow == std::string::npos) {
+				output.clear();
+				for (char label = 'A'; label <= 'z'; ++label) {
+					size_t count = 0;
+					for (const std::string& input : inputs) {
+						count += std::count(input.begin(), input.end(), label);
+					}
+					if (count == 1) {
+						output += label;
+					}
+				}
+				return;
+			}
+
+			output = compact.substr(arrow + 2);
+			for (size_t i = 0; i < output.size(); ++i) {
+				if (output.find(output[i], i + 1) != std::string::npos) {
+					throw std::invalid_argument("einsum output subscripts must be unique!");
+				}
+				if (lhs.find(output[i]) == std::string::npos || !std::isalpha(static_cast<unsigned char>(output[i]))) {
+					throw std::invalid_argument("einsum output subscripts must appear in the inputs!");
+				}
+			}
+		}
+
+		/*
+			Views `term` as the matrices [rows][cols], one per index of `batch`, where each of batch / rows / cols
+			is a group of labels. The view is free when each group is a contiguous run of the term's axes,
+			otherwise the term is gathered into exactly that order (summing out any label not in a group).
+		*/
+		inline OperandView make_view(const Term& term, const std::string& batch, const std::string& rows, const std::string& cols) {
+			std::vector<size_t> strides = term.strides();
+			OperandView view;
+
+			bool in_place = term.labels.size() == batch.size() + rows.size() + cols.size();
+			size_t group_strides[3] = { 0, 0, 0 };
+			const std::string* groups[3] = { &batch, &rows, &cols };
+			for (size_t g = 0; g < 3 && in_place; ++g) {
+				if (groups[g]->empty()) {
+					continue;
+				}
+				size_t position = term.labels.find(*groups[g]);
+				if (position == std::string::npos) {
+					in_place = false;
+					break;
+				}
+				// A run of dense axes behaves like one axis strided by its innermost axis.
+				group_strides[g] = strides[position + groups[g]->size() - 1];
+			}
+			if (in_place) {
+				view.batch_stride = group_strides[0];
+				view.row_stride = group_strides[1];
+				view.col_stride = group_strides[2];
+				return view;
+			}
+
+			Gather gather;
+			std::string order = batch + rows + cols;
+			for (char label : order) {
+				size_t axis = term.labels.find(label);
+				gather.shape.push_back(term.shape[axis]);
+				gather.strides.push_back(strides[axis]);
+			}
+			for (size_t axis = 0; axis < term.labels.size(); ++axis) {
+				if (order.find(term.labels[axis]) == std::string::npos) {
+					gather.reduce_shape.push_back(term.shape[axis]);
+					gather.reduce_strides.push_back(strides[axis]);
+				}
+			}
+
+			size_t col_size = 1;
+			size_t row_size = 1;
+			for (size_t i = 0; i < order.size(); ++i) {
+				if (i >= batch.size() + rows.size()) {
+					col_size *= gather.shape[i];
+				}
+				else if (i >= batch.size()) {
+					row_size *= gather.shape[i];
+				}
+			}
+			view.gather = std::move(gather);
+			view.batch_stride = row_size * col_size;
+			view.row_stride = col_size;
+			view.col_stride = 1;
+			return view;
+		}
+
+		/*
+			Prepares operand `index` on its own: collapses repeated labels into their diagonal and sums out the
+			labels that no other operand and not the output uses.
+		*/
+		inline Term prepare(const std::vector<std::string>& inputs, const std::string& output, const std::vector<size_t>& shape,
+			size_t index, std::optional<Gather>& gather) {
+			const std::string& labels = inputs[index];
+			Term dense{ labels, shape };
+			std::vector<size_t> strides = dense.strides();
+
+			Term res;
+			Gather diagonal;
+			bool needs_gather = false;
+			for (size_t axis = 0; axis < labels.size(); ++axis) {
+				char label = labels[axis];
+				size_t first = labels.find(label);
+				if (first != axis) {
+					// A repeated label, fold its stride into the first occurrence.
+					needs_gather = true;
+					continue;
+				}
+				size_t stride = 0;
+				for (size_t other = axis; other < labels.size(); ++other) {
+					if (labels[other] == label) {
+						stride += strides[other];
+					}
+				}
+
+				bool used_elsewhere = output.find(label) != std::string::npos;
+				for (size_t i = 0; i < inputs.size() && !used_elsewhere; ++i) {
+					used_elsewhere = i != index && inputs[i].find(label) != std::string::npos;
+				}
+				if (used_elsewhere) {
+					res.labels += label;
+					res.shape.push_back(shape[axis]);
+					diagonal.shape.push_back(shape[axis]);
+					diagonal.strides.push_back(stride);
+				}
+				else {
+					needs_gather = true;
+					diagonal.reduce_shape.push_back(shape[axis]);
+					diagonal.reduce_strides.push_back(stride);
+				}
+			}
+
+			if (needs_gather) {
+				gather = std::move(diagonal);
+			}
+			return res;
+		}
+
+		/*
+			The cost of contracting a with b, given the labels that are still needed afterwards.
+		*/
+		inline void contraction_cost(const Term& a, const Term& b, const std::string& needed, double& flops, double& result_size) {
+			flops = 1.0;
+			result_size = 1.0;
+			std::string seen;
+			for (const Term* term : { &a, &b }) {
+				for (size_t axis = 0; axis < term->labels.size(); ++axis) {
+					char label = term->labels[axis];
+					if (seen.find(label) != std::string::npos) {
+						continue;
+					}
+					seen += label;
+					flops *= static_cast<double>(term->shape[axis]);
+					if (needed.find(label) != std::string::npos) {
+						result_size *= static_cast<double>(term->shape[axis]);
+					}
+				}
+			}
+		}
+
+		/*
+			Plans the contraction of a with b into the result term `res`.
+		*/
+		inline Step plan_step(const Term& a, const Term& b, const std::string& needed, Term& res) {
+			std::string shared = intersect(a.labels, b.labels);
+			std::string a_free = intersect(subtract(a.labels, b.labels), needed);
+			std::string b_free = intersect(subtract(b.labels, a.labels), needed);
+
+			// The batch / contracted labels have to be in the same order in both views. Try the order of either
+			// operand and keep the one that gathers fewer elements.
+			Step best;
+			double best_cost = std::numeric_limits<double>::infinity();
+			for (const Term* order : { &a, &b }) {
+				std::string batch = intersect(intersect(order->labels, shared), needed);
+				std::string contracted = subtract(intersect(order->labels, shared), needed);
+
+				Step step;
+				step.a = make_view(a, batch, a_free, contracted);
+				step.b = make_view(b, batch, contracted, b_free);
+				double cost = (step.a.gather ? static_cast<double>(a.size()) : 0.0) + (step.b.gather ? static_cast<double>(b.size()) : 0.0);
+				if (cost < best_cost) {
+					best_cost = cost;
+					best = std::move(step);
+					res.labels = batch + a_free + b_free;
+				}
+			}
+
+			res.shape.clear();
+			for (char label : res.labels) {
+				size_t axis = a.labels.find(label);
+				res.shape.push_back(axis != std::string::npos ? a.shape[axis] : b.shape[b.labels.find(label)]);
+			}
+
+			auto group_size = [&res](size_t begin, size_t count) {
+				size_t size = 1;
+				for (size_t i = begin; i < begin + count; ++i) {
+					size *= res.shape[i];
+				}
+				return size;
+			};
+			size_t n_batch = res.labels.size() - a_free.size() - b_free.size();
+			best.batch = group_size(0, n_batch);
+			best.M = group_size(n_batch, a_free.size());
+			best.N = group_size(n_batch + a_free.size(), b_free.size());
+			best.K = 1;
+			for (size_t axis = 0; axis < a.labels.size(); ++axis) {
+				if (b.labels.find(a.labels[axis]) != std::string::npos && needed.find(a.labels[axis]) == std::string::npos) {
+					best.K *= a.shape[axis];
+				}
+			}
+			best.result_shape = res.shape;
+			double result_size;
+			contraction_cost(a, b, needed, best.flops, result_size);
+			return best;
+		}
+	}
+
+	/*
+		Builds the evaluation plan of `spec` for operands of the given shapes. Prefer plan(), which caches.
+	*/
+	inline Plan build_plan(const std::string& spec, const std::vector<std::vector<size_t>>& shapes) {
+		std::vector<std::string> inputs;
+		std::string output;
+		detail::parse(spec, shapes.size(), inputs, output);
+
+		std::unordered_map<char, size_t> dims;
+		for (size_t i = 0; i < inputs.size(); ++i) {
+			if (inputs[i].size() != shapes[i].size()) {
+				throw std::invalid_argument("The number of subscripts does not match the dimensions of operand " + std::to_string(i) + "!");
+			}
+			for (size_t axis = 0; axis < inputs[i].size(); ++axis) {
+				auto [it, inserted] = dims.emplace(inputs[i][axis], shapes[i][axis]);
+				if (!inserted && it->second != shapes[i][axis]) {
+					throw std::invalid_argument(std::string("Dimension mismatch for subscript '") + inputs[i][axis] + "'!");
+				}
+			}
+		}
+
+		Plan plan;
+		std::vector<detail::Term> terms;
+		plan.prepare.resize(inputs.size());
+		for (size_t i = 0; i < inputs.size(); ++i) {
+			terms.push_back(detail::prepare(inputs, output, shapes[i], i, plan.prepare[i]));
+		}
+
+		// Greedy pairwise order: contract the cheapest pair, until a single term is left.
+		std::vector<size_t> alive(terms.size());
+		for (size_t i = 0; i < alive.size(); ++i) {
+			alive[i] = i;
+		}
+		while (alive.size() > 1) {
+			size_t best_i = 0;
+			size_t best_j = 1;
+			double best_flops = std::numeric_limits<double>::infinity();
+			double best_size = std::numeric_limits<double>::infinity();
+			std::string best_needed;
+			for (size_t i = 0; i < alive.size(); ++i) {
+				for (size_t j = i + 1; j < alive.size(); ++j) {
+					std::string needed = output;
+					for (size_t k = 0; k < alive.size(); ++k) {
+						if (k != i && k != j) {
+							needed += terms[alive[k]].labels;
+						}
+					}
+					double flops, size;
+					detail::contraction_cost(terms[alive[i]], terms[alive[j]], needed, flops, size);
+					if (flops < best_flops || (flops == best_flops && size < best_size)) {
+						best_i = i;
+						best_j = j;
+						best_flops = flops;
+						best_size = size;
+						best_needed = needed;
+					}
+				}
+			}
+
+			detail::Term res;
+			Step step = detail::plan_step(terms[alive[best_i]], terms[alive[best_j]], best_needed, res);
+			step.lhs = alive[best_i];
+			step.rhs = alive[best_j];
+			plan.flops += step.flops;
+			plan.steps.push_back(std::move(step));
+
+			alive.erase(alive.begin() + best_j);
+			alive.erase(alive.begin() + best_i);
+			alive.push_back(terms.size());
+			terms.push_back(std::move(res));
+		}
+
+		const detail::Term& last = terms[alive[0]];
+		if (last.labels != output) {
+			plan.finish = detail::make_view(last, "", "", output).gather;
+		}
+		for (char label : output) {
+			plan.output_shape.push_back(dims[label]);
+		}
+		if (plan.output_shape.empty()) {
+			plan.output_shape.push_back(1);
+		}
+		return plan;
+	}
+
+	/*
+		Process-wide cache of einsum plans, keyed by the spec and the operand shapes. Planning is cheap compared to
+		large contractions, but einsum in a training loop is called with the same spec and shapes over and over.
+	*/
+	class PlanCache {
+	private:
+		std::mutex mutex;
+		std::unordered_map<std::string, std::shared_ptr<const Plan>> plans;
+		std::atomic<size_t> n_hits{ 0 };
+		std::atomic<size_t> n_misses{ 0 };
+
+		// Bounds the memory held by programs that generate many distinct shapes, the cache is dropped when full.
+		static constexpr size_t max_plans = 1024;
+
+		static std::string key_of(const std::string& spec, const std::vector<std::vector<size_t>>& shapes) {
+			std::string key = spec;
+			for (const std::vector<size_t>& shape : shapes) {
+				key += '|';
+				for (size_t dim : shape) {
+					key += std::to_string(dim);
+					key += 'x';
+				}
+			}
+			return key;
+		}
+
+	public:
+		static PlanCache& instance() {
+			static PlanCache cache;
+			return cache;
+		}
+
+		std::shared_ptr<const Plan> get(const std::string& spec, const std::vector<std::vector<size_t>>& shapes) {
+			std::string key = key_of(spec, shapes);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				auto it = plans.find(key);
+				if (it != plans.end()) {
+					n_hits.fetch_add(1, std::memory_order_relaxed);
+					return it->second;
+				}
+			}
+
+			// Planned outside the lock. If two threads race on the same key, both plans are identical.
+			n_misses.fetch_add(1, std::memory_order_relaxed);
+			std::shared_ptr<const Plan> plan = std::make_shared<const Plan>(build_plan(spec, shapes));
+			std::lock_guard<std::mutex> lock(mutex);
+			if (plans.size() >= max_plans) {
+				plans.clear();
+			}
+			return plans.emplace(std::move(key), std::move(plan)).first->second;
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lock(mutex);
+			plans.clear();
+			n_hits.store(0, std::memory_order_relaxed);
+			n_misses.store(0, std::memory_order_relaxed);
+		}
+
+		size_t size() {
+			std::lock_guard<std::mutex> lock(mutex);
+			return plans.size();
+		}
+
+		size_t hits() const {
+			return n_hits.load(std::memory_order_relaxed);
+		}
+
+		size_t misses() const {
+			return n_misses.load(std::memory_order_relaxed);
+		}
+	};
+
+	/*
+		Returns the (cached) plan of `spec` for operands of the given shapes.
+	*/
+	inline std::shared_ptr<const Plan> plan(const std::string& spec, const std::vector<std::vector<size_t>>& shapes) {
+		return PlanCache::instance().get(spec, shapes);
+	}
+
+	/*
+		Runs a Plan on NDArray<T> operands.
+	*/
+	template <typename T>
+	struct Executor {
+		static void reduce_into(const T* src, const Gather& gather, size_t dim, T& acc) {
+			if (dim == gather.reduce_shape.size()) {
+				acc += *src;
+				return;
+			}
+			for (size_t i = 0; i < gather.reduce_shape[dim]; ++i) {
+				reduce_into(src + i * gather.reduce_strides[dim], gather, dim + 1, acc);
+			}
+		}
+
+		static NDArray<T> gather(const NDArray<T>& src, const Gather& gather) {
+			NDArray<T> res(gather.shape);
+			const T* in = src._data().data();
+			T* out = res._mutable_data().data();
+			NDIter::Iterator<2> it(gather.shape, { NDIter::dense_strides(gather.shape),
+				std::vector<ptrdiff_t>(gather.strides.begin(), gather.strides.end()) });
+			if (gather.reduce_shape.empty()) {
+				// A pure permutation / diagonal: a strided copy in NDIter's coalesced chunks.
+				NDIter::transform(it, [](T value) { return value; }, out, in);
+				return res;
+			}
+
+			// Every destination element sums a (strided) block of the source.
+			size_t reduce_size = 1;
+			for (size_t dim : gather.reduce_shape) {
+				reduce_size *= dim;
+			}
+			it.for_each_chunk_weighted(reduce_size, [&gather](size_t count, const std::array<ptrdiff_t, 2>& strides, T* o, const T* i) {
+				for (size_t k = 0; k < count; ++k) {
+					T acc = T();
+					reduce_into(i + static_cast<ptrdiff_t>(k) * strides[1], gather, 0, acc);
+					o[static_cast<ptrdiff_t>(k) * strides[0]] = acc;
+				}
+			}, out, in);
+			return res;
+		}
+
+		static void set_shape(NDArray<T>& arr, const std::vector<size_t>& shape) {
+			arr.shape = shape;
+			arr.strides.resize(shape.size());
+			size_t stride = 1;
+			for (size_t d = shape.size(); d-- > 0;) {
+				arr.strides[d] = stride;
+				stride *= shape[d];
+			}
+		}
+
+		static NDArray<T> run(const Plan& plan, const std::vector<const NDArray<T>*>& operands) {
+			// The inputs are read in place; prepared operands and intermediate results are owned here and
+			// released as soon as the step consuming them is done.
+			struct Slot {
+				const NDArray<T>* input = nullptr;
+				NDArray<T> owned;
+
+				const NDArray<T>& get() const {
+					return input ? *input : owned;
+				}
+			};
+			std::deque<Slot> working;
+			for (size_t i = 0; i < operands.size(); ++i) {
+				Slot& slot = working.emplace_back();
+				if (plan.prepare[i]) {
+					slot.owned = gather(*operands[i], *plan.prepare[i]);
+				}
+				else {
+					slot.input = operands[i];
+				}
+			}
+
+			for (const Step& step : plan.steps) {
+				const NDArray<T>& lhs = working[step.lhs].get();
+				const NDArray<T>& rhs = working[step.rhs].get();
+				NDArray<T> a_tmp, b_tmp;
+				const T* a_ptr = lhs._data().data();
+				const T* b_ptr = rhs._data().data();
+				if (step.a.gather) {
+					a_tmp = gather(lhs, *step.a.gather);
+					a_ptr = a_tmp._data().data();
+				}
+				if (step.b.gather) {
+					b_tmp = gather(rhs, *step.b.gather);
+					b_ptr = b_tmp._data().data();
+				}
+
+				NDArray<T> res(step.result_shape);
+				NDArray<T>::_parallel_strided_matmul(a_ptr, step.a.batch_stride, step.a.row_stride, step.a.col_stride,
+					b_ptr, step.b.batch_stride, step.b.row_stride, step.b.col_stride,
+					res._mutable_data().data(), step.batch, step.M, step.N, step.K);
+
+				working[step.lhs] = Slot();
+				working[step.rhs] = Slot();
+				working.emplace_back().owned = std::move(res);
+			}
+
+			const Slot& last = working.back();
+			NDArray<T> res = plan.finish ? gather(last.get(), *plan.finish) : last.get();
+			set_shape(res, plan.output_shape);
+			return res;
+		}
+	};
+
+	/*
+		Evaluates the Einstein summation `spec` over the operands, see the namespace docs.
+
+		Params:
+			spec: e.g. "ij,jk->ik". Single letters label the axes; a label shared by several operands is
+				  multiplied along, labels missing from the output are summed over. Spaces are ignored.
+			operands: one NDArray per comma-separated term of the spec.
+	*/
+	template <typename T>
+	NDArray<T> einsum(const std::string& spec, const std::vector<const NDArray<T>*>& operands) {
+		std::vector<std::vector<size_t>> shapes;
+		for (const NDArray<T>* operand : operands) {
+			shapes.push_back(operand->get_shape());
+		}
+		return Executor<T>::run(*plan(spec, shapes), operands);
+	}
+
+	template <typename T, typename... Rest>
+	NDArray<T> einsum(const std::string& spec, const NDArray<T>& first, const Rest&... rest) {
+		return einsum<T>(spec, std::vector<const NDArray<T>*>{ &first, &rest... });
+	}
+}
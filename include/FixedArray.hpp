@@ -0,0 +1,351 @@
+#pragma once
+
+#include<array>
+#include<cmath>
+#include<stdexcept>
+#include<utility>
+#include<vector>
+#include "NDArray.hpp"
+
+/*
+	FixedArray is the compile-time sized sibling of NDArray, meant for the small 2x2 / 3x3 / 4x4 matrices
+	and short vectors that show up everywhere in geometry & model code.
+
+	The shape is part of the type: FixedArray<double, 3, 3> is a 3x3 matrix, FixedArray<float, 4> a 4-vector.
+	Because of that:
+		- the data lives in a std::array (on the stack / inline in the owning object), never on the heap.
+		- shape & strides are constexpr, so indexing compiles down to a constant offset.
+		- indices are not bounds checked at runtime, shape mismatches are compile errors instead.
+		- every kernel below is unrolled at compile time through std::index_sequence, so a 4x4 matmul is
+		  64 straight-line multiply-adds the compiler keeps in registers.
+
+	Use to_ndarray() / the NDArray constructor to move between the two representations.
+*/
+template <typename T, size_t... Dims>
+class FixedArray {
+	static_assert(sizeof...(Dims) > 0, "A FixedArray needs at least one dimension!");
+	static_assert(((Dims > 0) && ...), "Every dimension of a FixedArray must be non-zero!");
+
+public:
+	static constexpr size_t rank = sizeof...(Dims);
+	static constexpr size_t size = (Dims * ...);
+	static constexpr std::array<size_t, rank> shape = { Dims... };
+
+	/*
+		Row-major strides, same convention as NDArray: shape {2, 3, 4} -> strides {12, 4, 1}.
+	*/
+	static constexpr std::array<size_t, rank> strides = [] {
+		std::array<size_t, rank> res{};
+		size_t current_stride = 1;
+		for (size_t i = rank; i-- > 0;) {
+			res[i] = current_stride;
+			current_stride *= shape[i];
+		}
+		return res;
+	}();
+
+private:
+	/*
+		Past this many elements a fully unrolled body only bloats the binary, so the kernels fall back to
+		a plain loop (which the compiler is still free to unroll / vectorize on its own).
+	*/
+	static constexpr size_t max_unroll = 64;
+
+	/*
+		Calls f(std::integral_constant<size_t, I>{}) for I = 0 .. N-1.
+		The index is a compile-time constant inside f, so every array access has a fixed offset.
+	*/
+	template <size_t N, typename F>
+	static constexpr void unroll(F&& f) {
+		if constexpr (N <= max_unroll) {
+			[&]<size_t... I>(std::index_sequence<I...>) {
+				(f(std::integral_constant<size_t, I>{}), ...);
+			}(std::make_index_sequence<N>{});
+		}
+		else {
+			for (size_t i = 0; i < N; ++i) {
+				f(i);
+			}
+		}
+	}
+
+	template <typename U, size_t... OtherDims>
+	friend class FixedArray;
+
+	// The flattened data, row-major like NDArray.
+	std::array<T, size> data{};
+
+public:
+	// ==================== Constructor ======================
+	/*
+		Zero-initialized (value-initialized) fixed array.
+	*/
+	constexpr FixedArray() = default;
+
+	/*
+		Constructs a fixed array from its flattened, row-major data.
+	*/
+	constexpr explicit FixedArray(const std::array<T, size>& input_data) : data(input_data) {}
+
+	/*
+		Copies an NDArray into a fixed array, the shapes have to match exactly.
+	*/
+	explicit FixedArray(const NDArray<T>& other) {
+		if (other.get_shape() != std::vector<size_t>(shape.begin(), shape.end())) {
+			throw std::invalid_argument("The shape of the ndarray does not match the shape of the fixed array!");
+		}
+		const std::vector<T>& other_data = other.get_data();
+		unroll<size>([&](auto i) { data[i] = other_data[i]; });
+	}
+
+	/*
+		Returns the identity matrix, only available for square matrices.
+	*/
+	static constexpr FixedArray identity() requires (rank == 2 && shape[0] == shape[1]) {
+		FixedArray res;
+		unroll<shape[0]>([&](auto i) { res.data[i * (shape[0] + 1)] = T(1); });
+		return res;
+	}
+
+	/*
+		Returns a fixed array with every entry set to value.
+	*/
+	static constexpr FixedArray filled(T value) {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = value; });
+		return res;
+	}
+
+	constexpr void set_data(const std::array<T, size>& input_data) {
+		data = input_data;
+	}
+
+	// ====================== Accessor ========================
+	/*
+		Multi-dimensional access, e.g. m(1, 2). No bounds checks: pass exactly one index per dimension.
+	*/
+	template <typename... Indices>
+		requires (sizeof...(Indices) == rank)
+	constexpr T& operator()(Indices... indices) {
+		return data[flat_index(indices...)];
+	}
+
+	template <typename... Indices>
+		requires (sizeof...(Indices) == rank)
+	constexpr const T& operator()(Indices... indices) const {
+		return data[flat_index(indices...)];
+	}
+
+	/*
+		Flat (row-major) access.
+	*/
+	constexpr T& operator[](size_t i) {
+		return data[i];
+	}
+
+	constexpr const T& operator[](size_t i) const {
+		return data[i];
+	}
+
+	// ===================== Math Operations ======================
+	/*
+		Performs elementwise additions.
+
+		Params:
+			other: The second fixed array we are adding with.
+	*/
+	constexpr FixedArray operator+(const FixedArray& other) const {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = data[i] + other.data[i]; });
+		return res;
+	}
+
+	/*
+		Performs elementwise subtractions.
+
+		Params:
+			other: The fixed array we are subtracting.
+	*/
+	constexpr FixedArray operator-(const FixedArray& other) const {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = data[i] - other.data[i]; });
+		return res;
+	}
+
+	/*
+		Performs element-wise scalar multiplication.
+	*/
+	constexpr FixedArray operator*(T scalar) const {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = scalar * data[i]; });
+		return res;
+	}
+
+	/*
+		Performs element-wise scalar division.
+	*/
+	constexpr FixedArray operator/(T scalar) const {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = data[i] / scalar; });
+		return res;
+	}
+
+	/*
+		Performs elementwise (Hadamard) multiplication.
+	*/
+	constexpr FixedArray hadamard(const FixedArray& other) const {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = data[i] * other.data[i]; });
+		return res;
+	}
+
+	constexpr bool operator==(const FixedArray& other) const {
+		return data == other.data;
+	}
+
+	/*
+		Squares all the values in the data.
+	*/
+	constexpr FixedArray square() const {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = data[i] * data[i]; });
+		return res;
+	}
+
+	/*
+		Returns the square root of all entries.
+	*/
+	FixedArray square_root() const {
+		FixedArray res;
+		unroll<size>([&](auto i) { res.data[i] = std::sqrt(data[i]); });
+		return res;
+	}
+
+	/*
+		Returns the sum of all entries.
+	*/
+	constexpr T sum() const {
+		T result = T();
+		unroll<size>([&](auto i) { result += data[i]; });
+		return result;
+	}
+
+	/*
+		Returns the dot product of two vectors.
+	*/
+	constexpr T dot(const FixedArray& other) const requires (rank == 1) {
+		T result = T();
+		unroll<size>([&](auto i) { result += data[i] * other.data[i]; });
+		return result;
+	}
+
+	/*
+		Returns the transposed matrix, with the data actually moved into the new layout.
+	*/
+	constexpr FixedArray<T, shape[rank - 1], shape[0]> transpose() const requires (rank == 2) {
+		constexpr size_t M = shape[0];
+		constexpr size_t N = shape[1];
+		FixedArray<T, N, M> res;
+		unroll<size>([&](auto i) { res.data[(i % N) * M + i / N] = data[i]; });
+		return res;
+	}
+
+	// ----------- Matrix Multiplication --------------
+	/*
+		Computes the product of a (M x K) matrix with a (K x N) matrix. The shapes are checked at compile time.
+		Each output entry is an unrolled K-term multiply-add over compile-time offsets.
+
+		Params:
+			other: The second matrix.
+	*/
+	template <size_t N>
+	constexpr FixedArray<T, shape[0], N> matmul(const FixedArray<T, shape[rank - 1], N>& other) const requires (rank == 2) {
+		constexpr size_t M = shape[0];
+		constexpr size_t K = shape[1];
+		FixedArray<T, M, N> res;
+		unroll<M * N>([&](auto mn) {
+			const size_t m = mn / N;
+			const size_t n = mn % N;
+			T entry = T();
+			unroll<K>([&](auto k) { entry += data[m * K + k] * other.data[k * N + n]; });
+			res.data[mn] = entry;
+		});
+		return res;
+	}
+
+	/*
+		Computes the product of a (M x K) matrix with a K-vector, returning a M-vector.
+
+		Params:
+			other: The vector.
+	*/
+	constexpr FixedArray<T, shape[0]> matmul(const FixedArray<T, shape[rank - 1]>& other) const requires (rank == 2) {
+		constexpr size_t M = shape[0];
+		constexpr size_t K = shape[1];
+		FixedArray<T, M> res;
+		unroll<M>([&](auto m) {
+			T entry = T();
+			unroll<K>([&](auto k) { entry += data[m * K + k] * other.data[k]; });
+			res.data[m] = entry;
+		});
+		return res;
+	}
+
+	// =================== Utility Functions ======================
+	/*
+		Copies the fixed array into a (heap-backed) NDArray of the same shape.
+	*/
+	NDArray<T> to_ndarray() const {
+		NDArray<T> res(std::vector<size_t>(shape.begin(), shape.end()));
+		res.set_data(std::vector<T>(data.begin(), data.end()));
+		return res;
+	}
+
+	/*
+		Prints the fixed array in flattened form.
+	*/
+	void print_data() const {
+		std::cout << "[ ";
+		for (size_t i = 0; i < size; ++i) {
+			std::cout << data[i] << " ";
+		}
+		std::cout << "]" << std::endl;
+	}
+
+	// ================== Getter Functions ===========================
+	/*
+		returns the reference to the data attribute
+	*/
+	constexpr std::array<T, size>& get_data() {
+		return data;
+	}
+
+	constexpr const std::array<T, size>& get_data() const {
+		return data;
+	}
+
+	static constexpr std::array<size_t, rank> get_shape() {
+		return shape;
+	}
+
+	static constexpr std::array<size_t, rank> get_strides() {
+		return strides;
+	}
+
+private:
+	template <typename... Indices>
+	static constexpr size_t flat_index(Indices... indices) {
+		size_t flat = 0;
+		size_t dim = 0;
+		((flat += static_cast<size_t>(indices) * strides[dim++]), ...);
+		return flat;
+	}
+};
+
+// Common small shapes.
+template <typename T> using Vec2 = FixedArray<T, 2>;
+template <typename T> using Vec3 = FixedArray<T, 3>;
+template <typename T> using Vec4 = FixedArray<T, 4>;
+template <typename T> using Mat2 = FixedArray<T, 2, 2>;
+template <typename T> using Mat3 = FixedArray<T, 3, 3>;
+template <typename T> using Mat4 = FixedArray<T, 4, 4>;
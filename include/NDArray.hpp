@@ -2,14 +2,58 @@
 
 #include<iostream>
 #include<vector>
+#include<algorithm>
 #include<stdexcept>
 #include<format>
+#include<cmath>
+#include<memory>
+#include<atomic>
+#include "ThreadPool.hpp"
+#include "Reduction.hpp"
+#include "NDIter.hpp"
+
+/*
+	Process-wide counters of NDArray buffer traffic, handy for checking that a code path does not copy data.
+	Call reset() before the code under test and read the counters afterwards.
+*/
+struct NDArrayStats {
+	// # of NDArray copies that ended up sharing the source's buffer (O(1)).
+	static inline std::atomic<size_t> shared_copies{ 0 };
+	// # of times a full data buffer was duplicated, either on the first write to a shared buffer or
+	// when copying an array whose buffer cannot be shared.
+	static inline std::atomic<size_t> deep_copies{ 0 };
+	// # of data buffers allocated, for any reason (new arrays, results of ops, copy-on-write, ...).
+	static inline std::atomic<size_t> buffer_allocations{ 0 };
+
+	static void reset() {
+		shared_copies.store(0, std::memory_order_relaxed);
+		deep_copies.store(0, std::memory_order_relaxed);
+		buffer_allocations.store(0, std::memory_order_relaxed);
+	}
+};
+
+namespace NDEinsum {
+	template <typename T>
+	struct Executor;
+}
 
 template <typename T>
 class NDArray {
 private:
-	// The flattened data
-	std::vector<T> data;
+	// einsum lowers its contractions onto the GEMM kernel below.
+	friend struct NDEinsum::Executor<T>;
+
+	/*
+		The flattened data, stored in a reference-counted buffer with copy-on-write semantics:
+		copying an NDArray only bumps the reference count, and the buffer gets duplicated on the first write
+		to an array that still shares it (see _mutable_data()). Readers go through _data().
+
+		Once a mutable reference into the buffer has been handed out (non-const get_data() / operator()),
+		the caller could write through it at any time, so such an array is marked unshareable and copies of it
+		are deep copies again. Replacing the buffer (assignment, set_data) makes it shareable again.
+	*/
+	std::shared_ptr<std::vector<T>> buffer;
+	bool shareable = true;
 
 	/*
 		shape & strides are simply metadata for an ndarray:
@@ -56,6 +100,59 @@ private:
 		return flat_index;
 	}
 
+	/*
+		Allocates a new data buffer, every allocation of the class goes through here so it gets counted.
+	*/
+	template <typename... Args>
+	static std::shared_ptr<std::vector<T>> _new_buffer(Args&&... args) {
+		NDArrayStats::buffer_allocations.fetch_add(1, std::memory_order_relaxed);
+		return std::make_shared<std::vector<T>>(std::forward<Args>(args)...);
+	}
+
+	/*
+		True if nobody else reads this array's buffer, so an op on an expiring (rvalue) array can overwrite it.
+	*/
+	bool _reusable() const {
+		return buffer && buffer.use_count() == 1;
+	}
+
+	/*
+		Read-only view of the data, shared buffers are never copied for reads.
+	*/
+	const std::vector<T>& _data() const {
+		static const std::vector<T> empty;
+		return buffer ? *buffer : empty;
+	}
+
+	/*
+		Writable view of the data. Duplicates the buffer first if another NDArray still shares it.
+	*/
+	std::vector<T>& _mutable_data() {
+		if (!buffer) {
+			buffer = _new_buffer();
+		}
+		else if (buffer.use_count() > 1) {
+			buffer = _new_buffer(*buffer);
+			NDArrayStats::deep_copies.fetch_add(1, std::memory_order_relaxed);
+		}
+		return *buffer;
+	}
+
+	/*
+		Points this array at other's buffer (or at a private copy of it, if other's buffer cannot be shared).
+	*/
+	void _share_data(const NDArray& other) {
+		if (!other.buffer || other.shareable) {
+			buffer = other.buffer;
+			NDArrayStats::shared_copies.fetch_add(1, std::memory_order_relaxed);
+		}
+		else {
+			buffer = _new_buffer(*other.buffer);
+			NDArrayStats::deep_copies.fetch_add(1, std::memory_order_relaxed);
+		}
+		shareable = true;
+	}
+
 	/*
 		This is an internal function used for computing matrix multiplcation directly at memory address. 
 		The goal is to use this as a helper function for batched matrix multiplcation (high dimensional tensor multiplcation).
@@ -71,17 +168,140 @@ private:
 		
 	*/
 	static void _matmul(const T* A_ptr, const T* B_ptr, T* C_ptr, size_t M, size_t N, size_t K) {
+		_strided_matmul(A_ptr, K, 1, B_ptr, N, 1, C_ptr, M, N, K);
+	}
+
+	/*
+		_matmul for operands that are strided views, e.g. a transposed matrix is just A_ptr with a_row = 1 and
+		a_col = M, no copy needed. C is always written densely (row stride N).
+		The loops run m-k-n, so the innermost loop streams through a row of B and a row of C. Each C entry still
+		accumulates its K products in order k = 0, 1, ..., exactly like the m-n-k loop.
+
+		Params:
+			a_row, a_col: the distance between rows / columns of A.
+			b_row, b_col: the distance between rows / columns of B.
+	*/
+	static void _strided_matmul(const T* A_ptr, size_t a_row, size_t a_col, const T* B_ptr, size_t b_row, size_t b_col, T* C_ptr, size_t M, size_t N, size_t K) {
 		for (size_t m = 0; m < M; ++m) {
-			for (size_t n = 0; n < N; ++n) {
-				T entry = T();
-				for (size_t k = 0; k < K; ++k) {
-					entry += A_ptr[k + m * K] * B_ptr[k * N + n];
+			T* c = C_ptr + m * N;
+			const T* a = A_ptr + m * a_row;
+			std::fill(c, c + N, T());
+			for (size_t k = 0; k < K; ++k) {
+				T a_mk = a[k * a_col];
+				const T* b = B_ptr + k * b_row;
+				if (b_col == 1) {
+					for (size_t n = 0; n < N; ++n) {
+						c[n] += a_mk * b[n];
+					}
+				}
+				else {
+					for (size_t n = 0; n < N; ++n) {
+						c[n] += a_mk * b[n * b_col];
+					}
 				}
-				C_ptr[m * N + n] = entry;
 			}
 		}
 	}
 
+	/*
+		Runs _matmul over batch_count stacked (M x K) @ (K x N) products, split by output rows across the
+		shared thread pool. Rows of all batches form one iteration space, so both "many small matrices" and
+		"one big matrix" get parallelized.
+	*/
+	static void _parallel_matmul(const T* A_ptr, const T* B_ptr, T* C_ptr, size_t batch_count, size_t M, size_t N, size_t K) {
+		_parallel_strided_matmul(A_ptr, M * K, K, 1, B_ptr, K * N, N, 1, C_ptr, batch_count, M, N, K);
+	}
+
+	/*
+		_parallel_matmul over strided views, a_batch / b_batch being the distance between consecutive matrices.
+	*/
+	static void _parallel_strided_matmul(const T* A_ptr, size_t a_batch, size_t a_row, size_t a_col,
+		const T* B_ptr, size_t b_batch, size_t b_row, size_t b_col, T* C_ptr, size_t batch_count, size_t M, size_t N, size_t K) {
+		if (M == 0) {
+			return;
+		}
+		NDParallel::parallel_for(0, batch_count * M, [&](size_t row_begin, size_t row_end) {
+			size_t row = row_begin;
+			while (row < row_end) {
+				size_t batch = row / M;
+				size_t m = row % M;
+				size_t rows = std::min(M - m, row_end - row);
+				_strided_matmul(A_ptr + batch * a_batch + m * a_row, a_row, a_col, B_ptr + batch * b_batch, b_row, b_col,
+					C_ptr + batch * M * N + m * N, rows, N, K);
+				row += rows;
+			}
+		}, NDParallel::grain_for(N * K));
+	}
+
+	/*
+		Writes op(data[i]) into out[i] for every element, in parallel for large arrays.
+	*/
+	template <typename Op>
+	void _apply(T* out, Op op) const {
+		const T* in = _data().data();
+		NDParallel::parallel_for(0, _data().size(), [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				out[i] = op(in[i]);
+			}
+		});
+	}
+
+	/*
+		Writes op(data[i], other.data[i]) into out[i] for every element, in parallel for large arrays.
+	*/
+	template <typename Op>
+	void _apply(const NDArray<T>& other, T* out, Op op) const {
+		const T* lhs = _data().data();
+		const T* rhs = other._data().data();
+		NDParallel::parallel_for(0, _data().size(), [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				out[i] = op(lhs[i], rhs[i]);
+			}
+		});
+	}
+
+	/*
+		Shared implementation of the elementwise binary operators. lhs_tmp / rhs_tmp point at the operands that
+		are expiring (rvalues), or are null. The result is written into the buffer of the first expiring operand
+		that nobody else shares, so e.g. (a - b) + c allocates a single buffer. Otherwise a new one is allocated.
+	*/
+	template <typename Op>
+	static NDArray<T> _binary(const NDArray<T>& lhs, const NDArray<T>& rhs, NDArray<T>* lhs_tmp, NDArray<T>* rhs_tmp, Op op) {
+		if (lhs.shape != rhs.shape) {
+			throw std::invalid_argument("The two ndarrays must have the same shape!");
+		}
+
+		NDArray<T>* target = (lhs_tmp && lhs_tmp->_reusable()) ? lhs_tmp : (rhs_tmp && rhs_tmp->_reusable()) ? rhs_tmp : nullptr;
+		if (target) {
+			lhs._apply(rhs, target->buffer->data(), op);
+			return std::move(*target);
+		}
+
+		NDArray<T> result(lhs.shape);
+		lhs._apply(rhs, result._mutable_data().data(), op);
+		return result;
+	}
+
+	/*
+		Shared implementation of the elementwise unary ops, same buffer reuse rule as _binary().
+	*/
+	template <typename Op>
+	static NDArray<T> _unary(const NDArray<T>& src, NDArray<T>* src_tmp, Op op) {
+		if (src_tmp && src_tmp->_reusable()) {
+			src._apply(src_tmp->buffer->data(), op);
+			return std::move(*src_tmp);
+		}
+
+		NDArray<T> result(src.shape);
+		src._apply(result._mutable_data().data(), op);
+		return result;
+	}
+
+	static constexpr auto _plus = [](T a, T b) { return a + b; };
+	static constexpr auto _minus = [](T a, T b) { return a - b; };
+	static constexpr auto _squared = [](T a) { return a * a; };
+	static constexpr auto _sqrt = [](T a) { return static_cast<T>(std::sqrt(a)); };
+
 public:
 
 	// ==================== Constructor ======================
@@ -107,12 +327,12 @@ public:
 
 		// Resize Data
 		size_t total_size = current_stride;  // By now, we know the current stride actually contains the total number of elements in the ndarray.
-		data.resize(total_size, T());
+		buffer = _new_buffer(total_size, T());
 	}
 
-	// copy constructor
+	// copy constructor, O(1): the copy shares the data buffer until either side writes to it.
 	NDArray(const NDArray& other) {
-		this->data = std::vector<T>(other.data);
+		this->_share_data(other);
 		this->shape = std::vector<size_t>(other.shape);
 		this->strides = std::vector<size_t>(other.strides);
 	};
@@ -120,7 +340,7 @@ public:
 	// copy assignment operator
 	NDArray& operator=(const NDArray& other) {
 		if (&other == this) return *this;
-		this->data = std::vector<T>(other.data);
+		this->_share_data(other);
 		this->shape = std::vector<size_t>(other.shape);
 		this->strides = std::vector<size_t>(other.strides);
 
@@ -128,13 +348,11 @@ public:
 	}
 
 
-	// move constructor
-	NDArray(NDArray&& other) noexcept {
-		this->data = other.data;
-		this->shape = other.shape;
-		this->strides = other.strides;
-
-		other.data.clear();
+	// move constructor, O(1): steals the buffer and the shape/strides storage, other is left empty.
+	NDArray(NDArray&& other) noexcept
+		: buffer(std::move(other.buffer)), shareable(other.shareable), shape(std::move(other.shape)), strides(std::move(other.strides)) {
+		other.buffer.reset();
+		other.shareable = true;
 		other.shape.clear();
 		other.strides.clear();
 	}
@@ -142,12 +360,15 @@ public:
 
 	// move assignment operator
 	NDArray& operator=(NDArray&& other) noexcept {
-		if (other == *this) return *this;
-		this->data = other.data;
-		this->shape = other.shape;
-		this->strides = other.strides;
+		if (&other == this) return *this;
+		this->buffer = std::move(other.buffer);
+		this->shareable = other.shareable;
+		this->shape = std::move(other.shape);
+		this->strides = std::move(other.strides);
 
-		other.data.clear();
+		other.shareable = true;
+
+		other.buffer.reset();
 		other.shape.clear();
 		other.strides.clear();
 
@@ -156,86 +377,118 @@ public:
 
 
 	void set_data(const std::vector<T>& input_data) {
-		if (input_data.size() != data.size()) {
-			throw std::invalid_argument(std::format("The size of the data does not match the internal data size, input size should be {}", data.size()));
+		if (input_data.size() != _data().size()) {
+			throw std::invalid_argument(std::format("The size of the data does not match the internal data size, input size should be {}", _data().size()));
+		}
+		if (buffer.use_count() == 1) {
+			*buffer = input_data;
+		}
+		else {
+			// Somebody else still reads the old buffer, give this array a new one instead of duplicating the old.
+			buffer = _new_buffer(input_data);
+			shareable = true;
 		}
-		this->data = input_data;
 	}
 
 	void set_data(std::vector<T>&& input_data) {
-		if (input_data.size() != data.size()) {
-			throw std::invalid_argument(std::format("The size of the data does not match the internal data size, input size should be {}", data.size()));
+		if (input_data.size() != _data().size()) {
+			throw std::invalid_argument(std::format("The size of the data does not match the internal data size, input size should be {}", _data().size()));
+		}
+		if (buffer.use_count() == 1) {
+			*buffer = std::move(input_data);
+		}
+		else {
+			buffer = _new_buffer(std::move(input_data));
+			shareable = true;
 		}
-		this->data = std::move(input_data);
 	}
 
 	void set_size(int data_size) {
-		this->data.resize(data_size);
+		this->_mutable_data().resize(data_size);
 	}
 
 	// ====================== Accessor ========================
 	T& operator()(const std::vector<size_t>& indices) {
-		return data[get_index(indices)];
+		size_t index = get_index(indices);
+		shareable = false; // the caller can write through the returned reference at any time.
+		return _mutable_data()[index];
 	}
 
 	T operator()(const std::vector<size_t>& indices) const {
-		return data[get_index(indices)];
+		return _data()[get_index(indices)];
 	}
 
 	// Getter for shape
-	std::vector<size_t> get_shape() const {
+	const std::vector<size_t>& get_shape() const {
 		return shape;
 	}
 
+	/*
+		Returns true if both ndarrays currently read from the same data buffer.
+	*/
+	bool shares_data_with(const NDArray<T>& other) const {
+		return buffer && buffer == other.buffer;
+	}
+
 	// ===================== Math Operations ======================
 	/*
 		Performs elementwise tensor additions.
+		The rvalue overloads write the result into the buffer of an expiring operand instead of allocating.
 		
 		Params:
 			other: The second ndarray we are adding with.
 	*/
-	NDArray<T> operator+(const NDArray<T>& other) const {
-		if (shape != other.shape) {
-			throw std::invalid_argument("The two ndarrays must have the same shape!");
-		}
+	NDArray<T> operator+(const NDArray<T>& other) const& {
+		return _binary(*this, other, nullptr, nullptr, _plus);
+	}
 
-		NDArray<T> result(shape);
-		for (size_t i = 0; i < data.size(); i++) {
-			result.data[i] = data[i] + other.data[i];
-		}
-		return result;
+	NDArray<T> operator+(const NDArray<T>& other) && {
+		return _binary(*this, other, this, nullptr, _plus);
+	}
+
+	NDArray<T> operator+(NDArray<T>&& other) && {
+		return _binary(*this, other, this, &other, _plus);
+	}
+
+	friend NDArray<T> operator+(const NDArray<T>& lhs, NDArray<T>&& rhs) {
+		return _binary(lhs, rhs, nullptr, &rhs, _plus);
 	}
 
 	/*
-		Performs elementwise tensor additions.
+		Performs elementwise tensor subtractions.
+		The rvalue overloads write the result into the buffer of an expiring operand instead of allocating.
 
 		Params:
-			other: The second ndarray we are adding with.
+			other: The ndarray we are subtracting.
 	*/
-	NDArray<T> operator-(const NDArray<T>& other) const {
-		if (shape != other.shape) {
-			throw std::invalid_argument("The two ndarrays must have the same shape!");
-		}
+	NDArray<T> operator-(const NDArray<T>& other) const& {
+		return _binary(*this, other, nullptr, nullptr, _minus);
+	}
 
-		NDArray<T> result(shape);
-		for (size_t i = 0; i < data.size(); i++) {
-			result.data[i] = data[i] - other.data[i];
-		}
-		return result;
+	NDArray<T> operator-(const NDArray<T>& other) && {
+		return _binary(*this, other, this, nullptr, _minus);
+	}
+
+	NDArray<T> operator-(NDArray<T>&& other) && {
+		return _binary(*this, other, this, &other, _minus);
+	}
+
+	friend NDArray<T> operator-(const NDArray<T>& lhs, NDArray<T>&& rhs) {
+		return _binary(lhs, rhs, nullptr, &rhs, _minus);
 	}
 
 	/*
-		Performs elementwise tensor additions.
+		Performs element-wise scalar division.
 
 		Params:
-			other: The second ndarray we are adding with.
+			scalar: the value the tensor is divided by.
 	*/
-	NDArray<T> operator/(T scalar) const {
-		NDArray<T> result(shape);
-		for (size_t i = 0; i < data.size(); ++i) {
-			result.data[i] = data[i] / scalar;
-		}
-		return result;
+	NDArray<T> operator/(T scalar) const& {
+		return _unary(*this, nullptr, [scalar](T a) { return a / scalar; });
+	}
+
+	NDArray<T> operator/(T scalar) && {
+		return _unary(*this, this, [scalar](T a) { return a / scalar; });
 	}
 
 	/*
@@ -245,7 +498,7 @@ public:
 			other: The second ndarray;
 	*/
 	bool operator==(const NDArray<T>& other) const {
-		return (shape == other.shape) && (data == other.data);
+		return (shape == other.shape) && (buffer == other.buffer || _data() == other._data());
 	}
 
 	/*
@@ -254,12 +507,12 @@ public:
 		Params:
 			scalar: the value the tensor is multiplying by.
 	*/
-	NDArray<T> operator*(T scalar) const {
-		NDArray<T> result(shape);
-		for (size_t i = 0; i < data.size(); ++i) {
-			result.data[i] = scalar * data[i];
-		}
-		return result;
+	NDArray<T> operator*(T scalar) const& {
+		return _unary(*this, nullptr, [scalar](T a) { return scalar * a; });
+	}
+
+	NDArray<T> operator*(T scalar) && {
+		return _unary(*this, this, [scalar](T a) { return scalar * a; });
 	}
 
 // --------------------- Internal Properties -------------------------
@@ -271,62 +524,90 @@ public:
 
 	*/
 	NDArray<T> transpose(size_t dim1, size_t dim2) const {
-		// All we need is just to change the shape of the NDArray
-		// Plus changing the strides. 
-		std::vector<size_t> res_shape = this->shape;
-		res_shape[dim1] = this->shape[dim2];
-		res_shape[dim2] = this->shape[dim1];
-		NDArray<T> res(std::move(res_shape));
+		if (dim1 >= shape.size() || dim2 >= shape.size()) {
+			throw std::out_of_range("Dimension out of bounds!");
+		}
+		std::vector<size_t> axes(shape.size());
+		for (size_t i = 0; i < axes.size(); ++i) {
+			axes[i] = i;
+		}
+		std::swap(axes[dim1], axes[dim2]);
+		return permute(axes);
+	};
+
+	/*
+		Returns a (contiguous) ndarray whose i-th dimension is dimension axes[i] of this one.
+		ex. for a {2, 3, 4} array, permute({2, 0, 1}) has shape {4, 2, 3} and res(k, i, j) == this(i, j, k).
+
+		Params:
+			axes: a permutation of 0 ... rank - 1.
+	*/
+	NDArray<T> permute(const std::vector<size_t>& axes) const {
+		if (axes.size() != shape.size()) {
+			throw std::invalid_argument("The number of axes must match the dimensions!");
+		}
+		std::vector<size_t> res_shape(axes.size());
+		std::vector<size_t> src_strides(axes.size());
+		std::vector<bool> seen(axes.size(), false);
+		for (size_t i = 0; i < axes.size(); ++i) {
+			if (axes[i] >= shape.size() || seen[axes[i]]) {
+				throw std::invalid_argument("The axes must be a permutation of the dimensions!");
+			}
+			seen[axes[i]] = true;
+			res_shape[i] = shape[axes[i]];
+			src_strides[i] = strides[axes[i]];
+		}
 
+		// The destination is dense, the source is read through its permuted strides. The iterator merges the
+		// axes that stay adjacent (e.g. the trailing axes of a batch permutation) into contiguous inner chunks.
+		NDArray<T> res(res_shape);
+		std::vector<ptrdiff_t> res_strides = NDIter::dense_strides(res_shape);
+		NDIter::Iterator<2> it(res_shape, { res_strides, std::vector<ptrdiff_t>(src_strides.begin(), src_strides.end()) });
+		NDIter::transform(it, [](T value) { return value; }, res._mutable_data().data(), _data().data());
 		return res;
-	};
+	}
 
 
 	/*
 		This squares all the values in the data. We may consider leveraging CUDA for this purpose.
 		Should update the strides at the same time. 
+		Called on a temporary, e.g. (a - b).square(), the temporary's buffer is reused for the result.
 	*/
-	NDArray<T> square() {
-		std::vector<T> squared_data;
-		for (auto iter = this->data.begin(); iter != this->data.end(); iter++) {
-			squared_data.push_back((*iter) * (*iter));
-		}
+	NDArray<T> square() const& {
 		// note that the strides do not change.
-		NDArray<T> res(shape);
-		res.set_data(std::move(squared_data));
-		return res;
+		return _unary(*this, nullptr, _squared);
+	}
+
+	NDArray<T> square() && {
+		return _unary(*this, this, _squared);
 	}
 
 	/*
 		Returns the sum of all entries in the array.
+		The default Reproducible mode is compensated and gives the same bits for any thread count,
+		Fast mode is pairwise summation, see Reduction.hpp.
 	*/
-	T sum() {
-		T result = T();
-		for (auto& data : this->data) {
-			result += data;
-		}
-		return result;
+	T sum(NDReduction::Mode mode = NDReduction::Mode::Reproducible) const {
+		return NDReduction::sum(_data().data(), _data().size(), mode);
 	}
 
 	/* 
 		Returns the square root all entries in the array.
+		Called on a temporary, the temporary's buffer is reused for the result.
 	*/
-	NDArray<T> square_root() {
-		std::vector<T> square_root_data;
-		for (auto& data : this->data) {
-			square_root_data.push_back(std::sqrt(data));
-		}
+	NDArray<T> square_root() const& {
+		return _unary(*this, nullptr, _sqrt);
+	}
 
-		NDArray<T> res(shape);
-		res.set_data(square_root_data);
-		return res;
+	NDArray<T> square_root() && {
+		return _unary(*this, this, _sqrt);
 	}
 
 
 	/*
 		Returns the number of elements in the outermost dimension.
 	*/
-	size_t get_size() {
+	size_t get_size() const {
 		return shape[0];
 	}
 
@@ -344,8 +625,8 @@ public:
 	*/
 
 	double parse_double() {
-		if (this->data.size() == 1) {
-			return static_cast<double>(this->data[0]);
+		if (_data().size() == 1) {
+			return static_cast<double>(_data()[0]);
 		}
 		throw std::logic_error("The size of your data is not 1, cannot be parsed into a double!");
 	}
@@ -373,8 +654,6 @@ public:
 		size_t K = shape[shape.size() - 1];
 
 		size_t size_A = M * K;
-		size_t size_B = K * N;
-		size_t size_C = M * N;
 
 		// Parepare the result NDArray:
 		std::vector<size_t> res_shape(shape.begin(), shape.end() - 2);
@@ -383,21 +662,15 @@ public:
 		NDArray<T> res(res_shape);
 
 		// Get the pointers
-		const T* ptr_A = data.data();
-		const T* ptr_B = other.data.data();
-		T* ptr_C = res.data.data();
+		const T* ptr_A = _data().data();
+		const T* ptr_B = other._data().data();
+		T* ptr_C = res._mutable_data().data();
 
 		// Compute the size of the batch
-		size_t total_elements = data.size();
+		size_t total_elements = _data().size();
 		size_t batch_count = total_elements / size_A;
 
-		for (size_t i = 0; i < batch_count; ++i) {
-			_matmul(ptr_A, ptr_B, ptr_C, M, N, K);
-
-			ptr_A += size_A;
-			ptr_B += size_B;
-			ptr_C += size_C;
-		}
+		_parallel_matmul(ptr_A, ptr_B, ptr_C, batch_count, M, N, K);
 
 		return res;
 	}
@@ -424,7 +697,7 @@ public:
 		NDArray<T> result({M, N});
 		
 		// Recall taking the .data() property of a vector yields the pointer that points to the first value of the vector.
-		_matmul(data.data(), other.data.data(), result.data.data(), M, N, K);
+		_parallel_matmul(_data().data(), other._data().data(), result._mutable_data().data(), 1, M, N, K);
 
 		return result;
 	}
@@ -451,9 +724,9 @@ public:
 			for (size_t j = 0; j < other.shape[1]; ++j) {
 				T entry = T();
 				for (size_t z = 0; z < shape[1]; ++z) {
-					entry += data[i * strides[0] + z * strides[1]] * other.data[z * other.strides[0] + other.strides[1] * j];
+					entry += _data()[i * strides[0] + z * strides[1]] * other._data()[z * other.strides[0] + other.strides[1] * j];
 				}
-				result.data[i * result.strides[0] + j * result.strides[1]] = entry;
+				result._mutable_data()[i * result.strides[0] + j * result.strides[1]] = entry;
 			}
 		}
 		return result;
@@ -467,8 +740,8 @@ public:
 	*/
 	void print_data() const {
 		std::cout << "[ ";
-		for (size_t i = 0; i < data.size(); ++i) {
-			std::cout << data[i] << " ";
+		for (size_t i = 0; i < _data().size(); ++i) {
+			std::cout << _data()[i] << " ";
 		}
 		std::cout << "]" << std::endl;
 	}
@@ -490,7 +763,15 @@ public:
 		returns the reference to the data attribute
 	*/
 	std::vector<T>& get_data() {
-		return data;
+		shareable = false; // the caller can write through the returned reference at any time.
+		return _mutable_data();
+	}
+
+	/*
+		returns a read-only reference to the data attribute
+	*/
+	const std::vector<T>& get_data() const {
+		return _data();
 	}
 
 	/*
@@ -0,0 +1,244 @@
+#pragma once
+
+#include<algorithm>
+#include<array>
+#include<cstddef>
+#include<stdexcept>
+#include<tuple>
+#include<utility>
+#include<vector>
+#include "ThreadPool.hpp"
+
+/*
+	NDIter walks several strided operands of the same shape in lockstep, numpy nditer style.
+
+	Looping over an N-d shape with one flat index and a multiply-add per dimension per element is slow, and
+	walking a transposed operand in its logical order reads memory all over the place. An Iterator instead
+	normalizes the loop nest once, up front:
+		1. dimensions of extent 1 are dropped (their stride does not matter),
+		2. the remaining dimensions are sorted by stride, largest outermost, so the innermost loop moves through
+		   memory in the smallest steps (the first operand, the one written to, has priority),
+		3. neighbouring dimensions that are laid out back to back in every operand are merged into one.
+	A dense array of any rank becomes a single dimension, a permuted one usually becomes two or three.
+
+	The work is then handed out as inner 1-D chunks: a base pointer per operand, one stride per operand and a
+	length. When every inner stride is 1 the chunk is a plain contiguous loop the compiler vectorizes.
+	Strides are in elements and signed, so reversed (negative) and broadcast (0) operands work too.
+*/
+namespace NDIter {
+
+	template <size_t N>
+	class Iterator {
+
+	private:
+		std::vector<size_t> dims;                   // outermost first, after dropping / sorting / merging.
+		std::vector<std::array<ptrdiff_t, N>> steps; // steps[d][op]: the stride of operand op along dims[d].
+		size_t total = 0;
+
+		template <typename F, typename Bases, size_t... I>
+		static void call(F& kernel, size_t count, const std::array<ptrdiff_t, N>& inner, const Bases& bases,
+			const std::array<ptrdiff_t, N>& offsets, std::index_sequence<I...>) {
+			kernel(count, inner, (std::get<I>(bases) + offsets[I])...);
+		}
+
+	public:
+		/*
+			Params:
+				shape: the common (logical) shape of the operands.
+				strides: per operand, its stride (in elements) along each dimension of shape.
+		*/
+		Iterator(const std::vector<size_t>& shape, const std::array<std::vector<ptrdiff_t>, N>& strides) {
+			total = 1;
+			for (size_t dim : shape) {
+				total *= dim;
+			}
+			for (const std::vector<ptrdiff_t>& operand_strides : strides) {
+				if (operand_strides.size() != shape.size()) {
+					throw std::invalid_argument("Every operand needs one stride per dimension!");
+				}
+			}
+
+			std::vector<size_t> order;
+			for (size_t d = 0; d < shape.size(); ++d) {
+				if (shape[d] != 1) {
+					order.push_back(d);
+				}
+			}
+			auto magnitude = [](ptrdiff_t stride) { return stride < 0 ? -stride : stride; };
+			std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+				for (size_t op = 0; op < N; ++op) {
+					if (magnitude(strides[op][a]) != magnitude(strides[op][b])) {
+						return magnitude(strides[op][a]) > magnitude(strides[op][b]);
+					}
+				}
+				return false;
+			});
+
+			for (size_t d : order) {
+				std::array<ptrdiff_t, N> step;
+				for (size_t op = 0; op < N; ++op) {
+					step[op] = strides[op][d];
+				}
+
+				// dims.back() is the next outer dimension: mergeable if it advances every operand by exactly
+				// one full sweep of this dimension.
+				bool mergeable = !dims.empty();
+				for (size_t op = 0; op < N && mergeable; ++op) {
+					mergeable = steps.back()[op] == step[op] * static_cast<ptrdiff_t>(shape[d]);
+				}
+				if (mergeable) {
+					dims.back() *= shape[d];
+					steps.back() = step;
+				}
+				else {
+					dims.push_back(shape[d]);
+					steps.push_back(step);
+				}
+			}
+
+			if (dims.empty()) {
+				dims.push_back(1);
+				steps.push_back(std::array<ptrdiff_t, N>{});
+			}
+		}
+
+		// The loop nest after normalization, outermost first.
+		const std::vector<size_t>& get_shape() const {
+			return dims;
+		}
+
+		const std::vector<std::array<ptrdiff_t, N>>& get_strides() const {
+			return steps;
+		}
+
+		size_t get_size() const {
+			return total;
+		}
+
+		// The length of the inner 1-D chunks.
+		size_t inner_size() const {
+			return dims.back();
+		}
+
+		// Whether the inner chunks are contiguous in every operand.
+		bool inner_contiguous() const {
+			return std::all_of(steps.back().begin(), steps.back().end(), [](ptrdiff_t stride) { return stride == 1; });
+		}
+
+		/*
+			Calls kernel(count, inner_strides, ptrs...) once per inner chunk, in parallel for large loops: ptrs are the
+			operands' pointers to the first element of the chunk, inner_strides their strides within it.
+			Different chunks must not write to the same element, i.e. the written operands must not be broadcast.
+
+			Params:
+				kernel: callable taking (size_t count, const std::array<ptrdiff_t, N>& inner_strides, Ptrs... ptrs).
+				bases: per operand, a pointer to its element at index (0, ..., 0).
+		*/
+		template <typename F, typename... Ptrs>
+		void for_each_chunk(F&& kernel, Ptrs... bases) const {
+			for_each_chunk_weighted(1, kernel, bases...);
+		}
+
+		/*
+			for_each_chunk() for kernels that do about `work_per_element` units of work per element (see
+			NDParallel::grain_for), so expensive elements get split across threads at smaller sizes.
+		*/
+		template <typename F, typename... Ptrs>
+		void for_each_chunk_weighted(size_t work_per_element, F&& kernel, Ptrs... bases) const {
+			static_assert(sizeof...(Ptrs) == N, "for_each_chunk needs one base pointer per operand!");
+			if (total == 0) {
+				return;
+			}
+
+			std::tuple<Ptrs...> base_tuple(bases...);
+			const std::array<ptrdiff_t, N>& inner = steps.back();
+			size_t inner_count = dims.back();
+			size_t outer_count = total / inner_count;
+			size_t outer_rank = dims.size() - 1;
+
+			if (outer_count == 1) {
+				// A single chunk, e.g. a dense array: split the chunk itself so it still runs in parallel.
+				NDParallel::parallel_for(0, inner_count, [&](size_t begin, size_t end) {
+					std::array<ptrdiff_t, N> offsets;
+					for (size_t op = 0; op < N; ++op) {
+						offsets[op] = static_cast<ptrdiff_t>(begin) * inner[op];
+					}
+					call(kernel, end - begin, inner, base_tuple, offsets, std::index_sequence_for<Ptrs...>());
+				}, NDParallel::grain_for(work_per_element));
+				return;
+			}
+
+			NDParallel::parallel_for(0, outer_count, [&](size_t begin, size_t end) {
+				// An odometer over the outer dimensions, tracking each operand's offset.
+				std::vector<size_t> index(outer_rank);
+				std::array<ptrdiff_t, N> offsets{};
+				for (size_t d = outer_rank, rest = begin; d-- > 0;) {
+					index[d] = rest % dims[d];
+					rest /= dims[d];
+					for (size_t op = 0; op < N; ++op) {
+						offsets[op] += static_cast<ptrdiff_t>(index[d]) * steps[d][op];
+					}
+				}
+
+				for (size_t chunk = begin; chunk < end; ++chunk) {
+					call(kernel, inner_count, inner, base_tuple, offsets, std::index_sequence_for<Ptrs...>());
+					for (size_t d = outer_rank; d-- > 0;) {
+						for (size_t op = 0; op < N; ++op) {
+							offsets[op] += steps[d][op];
+						}
+						if (++index[d] < dims[d]) {
+							break;
+						}
+						for (size_t op = 0; op < N; ++op) {
+							offsets[op] -= static_cast<ptrdiff_t>(index[d]) * steps[d][op];
+						}
+						index[d] = 0;
+					}
+				}
+			}, NDParallel::grain_for(inner_count * work_per_element));
+		}
+	};
+
+	namespace detail {
+		template <typename Op, typename Out, size_t... J, typename... Ins>
+		void strided_chunk(size_t count, const std::array<ptrdiff_t, sizeof...(Ins) + 1>& strides, Op& op, Out* out,
+			std::index_sequence<J...>, const Ins*... in) {
+			for (size_t k = 0; k < count; ++k) {
+				ptrdiff_t i = static_cast<ptrdiff_t>(k);
+				out[i * strides[0]] = op(in[i * strides[J + 1]]...);
+			}
+		}
+	}
+
+	/*
+		Elementwise out = op(in...) over the iterator's layout (operand 0 is out, operand j + 1 is in[j]).
+		Contiguous chunks run a plain indexed loop, for SIMD; strided chunks step through memory.
+	*/
+	template <typename Op, typename Out, typename... Ins>
+	void transform(const Iterator<sizeof...(Ins) + 1>& it, Op op, Out* out, const Ins*... in) {
+		it.for_each_chunk([&op](size_t count, const std::array<ptrdiff_t, sizeof...(Ins) + 1>& strides, Out* o, const Ins*... i) {
+			bool contiguous = std::all_of(strides.begin(), strides.end(), [](ptrdiff_t stride) { return stride == 1; });
+			if (contiguous) {
+				for (size_t k = 0; k < count; ++k) {
+					o[k] = op(i[k]...);
+				}
+			}
+			else {
+				detail::strided_chunk(count, strides, op, o, std::index_sequence_for<Ins...>(), i...);
+			}
+		}, out, in...);
+	}
+
+	/*
+		Returns the strides of a dense (row-major) array of the given shape, for building Iterators.
+	*/
+	inline std::vector<ptrdiff_t> dense_strides(const std::vector<size_t>& shape) {
+		std::vector<ptrdiff_t> res(shape.size());
+		ptrdiff_t stride = 1;
+		for (size_t d = shape.size(); d-- > 0;) {
+			res[d] = stride;
+			stride *= static_cast<ptrdiff_t>(shape[d]);
+		}
+		return res;
+	}
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include<algorithm>
+#include<cmath>
+#include<type_traits>
+#include "ThreadPool.hpp"
+
+/*
+	NDReduction is the summation engine behind NDArray::sum() and the model costs.
+
+	A plain `result += x[i]` loop loses about one ulp per addition, so over millions of doubles the error grows
+	linearly with the length (and with float it can be off in the leading digits). Two modes are offered:
+
+		- Fast: pairwise summation. Each leaf of 128 elements is summed in 8 independent accumulators (which the
+		  compiler turns into SIMD adds) and the leaves are added up in a binary tree, so the error only grows
+		  with log(n). The parallel blocks are sized by the thread count, so the last bits can differ between
+		  thread counts.
+
+		- Reproducible: compensated (TwoSum) summation over fixed blocks of `reproducible_block` elements,
+		  combined in the fixed pairwise tree of NDParallel::parallel_reduce. The compensation makes the result
+		  accurate to about one rounding of the exact sum, and the evaluation order only depends on the length
+		  of the input, so the result is bit-identical for any thread count.
+
+	Both modes spell out their lanes in the source instead of relying on the vectorizer to reassociate, so (without
+	-ffast-math) the result does not depend on the SIMD width either. float is accumulated in double.
+*/
+namespace NDReduction {
+
+	enum class Mode {
+		Fast,
+		Reproducible
+	};
+
+	// The number of elements summed by one leaf of the pairwise tree.
+	inline constexpr size_t pairwise_block = 128;
+
+	// The number of elements per parallel block in Reproducible mode. Fixed, so it cannot depend on the machine.
+	inline constexpr size_t reproducible_block = 1 << 14;
+
+	template <typename T>
+	using accumulator_t = std::conditional_t<std::is_same_v<T, float>, double, T>;
+
+	namespace detail {
+		/*
+			Pairwise sum of value(i) over [begin, end). The split points are multiples of 8, so every leaf but the
+			last runs the full 8-lane body.
+		*/
+		template <typename Acc, typename F>
+		Acc pairwise_sum(size_t begin, size_t end, const F& value) {
+			size_t n = end - begin;
+			if (n > pairwise_block) {
+				size_t half = (n / 2) & ~size_t(7);
+				return pairwise_sum<Acc>(begin, begin + half, value) + pairwise_sum<Acc>(begin + half, end, value);
+			}
+
+			Acc lanes[8] = {};
+			size_t i = begin;
+			for (; i + 8 <= end; i += 8) {
+				for (size_t l = 0; l < 8; ++l) {
+					lanes[l] += static_cast<Acc>(value(i + l));
+				}
+			}
+			Acc res = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+			for (; i < end; ++i) {
+				res += static_cast<Acc>(value(i));
+			}
+			return res;
+		}
+
+		/*
+			A running sum plus the rounding error it has accumulated so far.
+		*/
+		template <typename Acc>
+		struct Compensated {
+			Acc sum = Acc();
+			Acc error = Acc();
+
+			// Knuth's TwoSum: the exact rounding error of sum + x, without comparing magnitudes (no branches,
+			// so the lanes below vectorize).
+			void add(Acc x) {
+				Acc t = sum + x;
+				Acc x_part = t - sum;
+				error += (sum - (t - x_part)) + (x - x_part);
+				sum = t;
+			}
+
+			static Compensated merge(const Compensated& a, const Compensated& b) {
+				Compensated res = a;
+				res.add(b.sum);
+				res.error += b.error;
+				return res;
+			}
+
+			Acc value() const {
+				return sum + error;
+			}
+		};
+
+		/*
+			Compensated sum of value(i) over [begin, end) in 8 interleaved lanes. A single compensated accumulator
+			is a chain of dependent adds, the lanes keep several chains in flight (and in one SIMD register).
+		*/
+		template <typename Acc, typename F>
+		Compensated<Acc> compensated_sum(size_t begin, size_t end, const F& value) {
+			Compensated<Acc> lanes[8];
+			size_t i = begin;
+			for (; i + 8 <= end; i += 8) {
+				for (size_t l = 0; l < 8; ++l) {
+					lanes[l].add(static_cast<Acc>(value(i + l)));
+				}
+			}
+			for (size_t l = 0; i < end; ++i, ++l) {
+				lanes[l].add(static_cast<Acc>(value(i)));
+			}
+			for (size_t step = 1; step < 8; step *= 2) {
+				for (size_t l = 0; l < 8; l += 2 * step) {
+					lanes[l] = Compensated<Acc>::merge(lanes[l], lanes[l + step]);
+				}
+			}
+			return lanes[0];
+		}
+	}
+
+	/*
+		Returns the sum of value(i) for i in [0, n), without materializing the values.
+
+		Params:
+			n: the number of terms.
+			value: callable taking a size_t index and returning a T.
+			mode: see the Mode docs above.
+	*/
+	template <typename T, typename F>
+	T transform_sum(size_t n, F&& value, Mode mode = Mode::Reproducible) {
+		using Acc = accumulator_t<T>;
+
+		if constexpr (!std::is_floating_point_v<T>) {
+			// Integer sums are exact, so the cheapest order is also a reproducible one.
+			mode = Mode::Fast;
+		}
+
+		if (mode == Mode::Fast) {
+			size_t threads = NDParallel::get_num_threads();
+			size_t grain = std::max(NDParallel::min_parallel_work, (n + threads - 1) / threads);
+			return static_cast<T>(NDParallel::parallel_reduce(size_t(0), n, Acc(),
+				[&value](size_t begin, size_t end) { return detail::pairwise_sum<Acc>(begin, end, value); },
+				[](Acc a, Acc b) { return a + b; },
+				grain));
+		}
+
+		if constexpr (std::is_floating_point_v<T>) {
+			detail::Compensated<Acc> total = NDParallel::parallel_reduce(size_t(0), n, detail::Compensated<Acc>(),
+				[&value](size_t begin, size_t end) { return detail::compensated_sum<Acc>(begin, end, value); },
+				[](const detail::Compensated<Acc>& a, const detail::Compensated<Acc>& b) { return detail::Compensated<Acc>::merge(a, b); },
+				reproducible_block);
+			return static_cast<T>(total.value());
+		}
+		return T();
+	}
+
+	/*
+		Returns the sum of data[0] ... data[n - 1].
+	*/
+	template <typename T>
+	T sum(const T* data, size_t n, Mode mode = Mode::Reproducible) {
+		return transform_sum<T>(n, [data](size_t i) { return data[i]; }, mode);
+	}
+}
@@ -0,0 +1,471 @@
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<condition_variable>
+#include<deque>
+#include<exception>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<optional>
+#include<thread>
+#include<utility>
+#include<vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include<windows.h>
+#elif defined(__linux__)
+#include<pthread.h>
+#include<sched.h>
+#endif
+
+/*
+	NDParallel is the single threading runtime shared by NDArray and BWMLLib.
+
+	Every op goes through the same lazily-created ThreadPool instead of spawning its own threads, so:
+		- threads are created once per process, not once per call.
+		- nested parallel regions (e.g. a parallel op inside a parallel training loop) run serially
+		  on the thread that reached them instead of oversubscribing the cores.
+
+	The thread count is the number of threads working on one parallel region, the calling thread included.
+	It is taken from (in order): the innermost ThreadScope on the calling thread, then set_num_threads(),
+	then std::thread::hardware_concurrency().
+*/
+namespace NDParallel {
+
+	/*
+		Below this many "units of work" (roughly one multiply-add each) a region is not worth splitting:
+		waking a worker costs a few microseconds, which is more than the work itself.
+	*/
+	inline constexpr size_t min_parallel_work = 1 << 15;
+
+	/*
+		Returns the grain size, i.e. the minimum number of iterations handed to one task, for a loop
+		whose iterations each cost about `work_per_item` units of work.
+	*/
+	inline size_t grain_for(size_t work_per_item) {
+		return std::max<size_t>(1, min_parallel_work / std::max<size_t>(1, work_per_item));
+	}
+
+	namespace detail {
+		inline std::atomic<size_t>& global_num_threads() {
+			static std::atomic<size_t> n_threads{ 0 }; // 0 = one per hardware core.
+			return n_threads;
+		}
+
+		// Per-thread override installed by ThreadScope, 0 = no override.
+		inline size_t& scoped_num_threads() {
+			thread_local size_t n_threads = 0;
+			return n_threads;
+		}
+
+		// True while the thread is executing (part of) a parallel region, parallel calls from there run serially.
+		inline bool& in_parallel_region() {
+			thread_local bool in_region = false;
+			return in_region;
+		}
+
+		// Index of the pool worker running on this thread, or -1 on any other thread.
+		inline long& worker_index() {
+			thread_local long index = -1;
+			return index;
+		}
+
+		inline size_t hardware_threads() {
+			return std::max<size_t>(1, std::thread::hardware_concurrency());
+		}
+
+		/*
+			Pins the calling thread to one core. Failures are ignored, pinning is only an optimization.
+		*/
+		inline void pin_current_thread(size_t core) {
+#if defined(_WIN32)
+			size_t n_cores = std::min<size_t>(hardware_threads(), sizeof(DWORD_PTR) * 8);
+			SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (core % n_cores));
+#elif defined(__linux__)
+			cpu_set_t allowed;
+			CPU_ZERO(&allowed);
+			if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+				return;
+			}
+			// Pin to the core-th core the process is allowed to run on (wrapping around).
+			size_t target = core % static_cast<size_t>(CPU_COUNT(&allowed));
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+				if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+					cpu_set_t mask;
+					CPU_ZERO(&mask);
+					CPU_SET(cpu, &mask);
+					pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+					return;
+				}
+			}
+#else
+			(void)core;
+#endif
+		}
+	}
+
+	/*
+		A work-stealing thread pool.
+
+		Each worker owns a deque of tasks. A worker pops its own newest task first (LIFO, the data it just
+		touched is still in cache) and, when its deque runs dry, steals the oldest task of another worker (FIFO,
+		usually the biggest remaining piece of work). Tasks submitted from outside the pool are spread round-robin.
+		Worker i is pinned to core i + 1, leaving core 0 to the thread that usually submits the work.
+
+		Workers are only ever added, never removed, so the pool can grow when a caller asks for more threads.
+	*/
+	class ThreadPool {
+	private:
+		using Task = std::function<void()>;
+
+		struct WorkerQueue {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		// Queues are allocated up front so that growing the pool never moves a queue another thread is using.
+		static constexpr size_t max_workers = 256;
+
+		std::unique_ptr<WorkerQueue[]> queues;
+		std::vector<std::thread> workers;
+		std::atomic<size_t> n_workers{ 0 };
+		std::atomic<size_t> next_queue{ 0 };
+		std::atomic<size_t> pending{ 0 };
+		std::mutex grow_mutex;
+		std::mutex sleep_mutex;
+		std::condition_variable wake;
+		bool stopping = false;
+		bool pin_threads;
+
+		bool pop_local(size_t index, Task& task) {
+			WorkerQueue& queue = queues[index];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty()) {
+				return false;
+			}
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			return true;
+		}
+
+		bool steal(size_t thief, Task& task) {
+			size_t count = n_workers.load(std::memory_order_acquire);
+			for (size_t offset = 1; offset <= count; ++offset) {
+				WorkerQueue& victim = queues[(thief + offset) % count];
+				std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+				if (!lock.owns_lock() || victim.tasks.empty()) {
+					continue;
+				}
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return true;
+			}
+			return false;
+		}
+
+		void run(Task& task) {
+			pending.fetch_sub(1, std::memory_order_acq_rel);
+			task();
+		}
+
+		void worker_loop(size_t index) {
+			detail::worker_index() = static_cast<long>(index);
+			detail::in_parallel_region() = true;
+			if (pin_threads) {
+				detail::pin_current_thread(index + 1);
+			}
+
+			Task task;
+			while (true) {
+				if (pop_local(index, task) || steal(index, task)) {
+					run(task);
+					task = nullptr;
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(sleep_mutex);
+				wake.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+				if (stopping && pending.load(std::memory_order_acquire) == 0) {
+					return;
+				}
+			}
+		}
+
+	public:
+		explicit ThreadPool(size_t n_workers = 0, bool pin_threads = true)
+			: queues(new WorkerQueue[max_workers]), pin_threads(pin_threads) {
+			ensure_workers(n_workers);
+		}
+
+		~ThreadPool() {
+			{
+				std::lock_guard<std::mutex> lock(sleep_mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (std::thread& worker : workers) {
+				worker.join();
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/*
+			The process-wide pool used by parallel_for / parallel_reduce. Created on first use with one worker
+			per core besides the calling thread.
+		*/
+		static ThreadPool& instance() {
+			static ThreadPool pool(detail::hardware_threads() - 1);
+			return pool;
+		}
+
+		/*
+			Grows the pool to at least `count` workers (capped at max_workers).
+		*/
+		void ensure_workers(size_t count) {
+			count = std::min(count, max_workers);
+			if (n_workers.load(std::memory_order_acquire) >= count) {
+				return;
+			}
+			std::lock_guard<std::mutex> lock(grow_mutex);
+			while (workers.size() < count) {
+				size_t index = workers.size();
+				workers.emplace_back(&ThreadPool::worker_loop, this, index);
+				n_workers.store(workers.size(), std::memory_order_release);
+			}
+		}
+
+		size_t size() const {
+			return n_workers.load(std::memory_order_acquire);
+		}
+
+		/*
+			Queues a task. From a worker the task goes onto that worker's own deque, otherwise round-robin.
+		*/
+		void submit(Task task) {
+			size_t count = size();
+			if (count == 0) {
+				task();
+				return;
+			}
+
+			long self = detail::worker_index();
+			size_t index = self >= 0 ? static_cast<size_t>(self) : next_queue.fetch_add(1, std::memory_order_relaxed) % count;
+			{
+				std::lock_guard<std::mutex> lock(queues[index].mutex);
+				queues[index].tasks.push_back(std::move(task));
+			}
+			{
+				// Taking the sleep lock orders the increment with a worker checking the wait predicate.
+				std::lock_guard<std::mutex> lock(sleep_mutex);
+				pending.fetch_add(1, std::memory_order_acq_rel);
+			}
+			wake.notify_one();
+		}
+
+		/*
+			Runs one queued task on the calling thread, if there is one. Lets a thread that waits on a parallel
+			region help with it instead of idling.
+		*/
+		bool try_run_one() {
+			size_t count = size();
+			if (count == 0) {
+				return false;
+			}
+			long self = detail::worker_index();
+			size_t start = self >= 0 ? static_cast<size_t>(self) : next_queue.load(std::memory_order_relaxed) % count;
+
+			Task task;
+			if ((self >= 0 && pop_local(start, task)) || steal(start, task)) {
+				run(task);
+				return true;
+			}
+			return false;
+		}
+	};
+
+	// ==================== Thread Count ======================
+	/*
+		Sets the library-wide thread count. 0 restores the default of one thread per hardware core.
+	*/
+	inline void set_num_threads(size_t n_threads) {
+		detail::global_num_threads().store(n_threads, std::memory_order_relaxed);
+	}
+
+	/*
+		Returns the number of threads a parallel region started from the calling thread would use.
+	*/
+	inline size_t get_num_threads() {
+		size_t n_threads = detail::scoped_num_threads();
+		if (n_threads == 0) {
+			n_threads = detail::global_num_threads().load(std::memory_order_relaxed);
+		}
+		return n_threads == 0 ? detail::hardware_threads() : n_threads;
+	}
+
+	/*
+		Overrides the thread count for the calling thread until the scope ends, e.g.
+			{
+				NDParallel::ThreadScope serial(1);
+				a + b; // runs on the calling thread only.
+			}
+	*/
+	class ThreadScope {
+	private:
+		size_t previous;
+
+	public:
+		explicit ThreadScope(size_t n_threads) : previous(detail::scoped_num_threads()) {
+			detail::scoped_num_threads() = n_threads;
+		}
+
+		~ThreadScope() {
+			detail::scoped_num_threads() = previous;
+		}
+
+		ThreadScope(const ThreadScope&) = delete;
+		ThreadScope& operator=(const ThreadScope&) = delete;
+	};
+
+	// ==================== Parallel Loops ======================
+	/*
+		Calls fn(chunk_begin, chunk_end) over disjoint chunks covering [begin, end), in parallel when worth it.
+
+		The range is run serially on the calling thread when it is shorter than two grains, when only one
+		thread is configured, or when the caller already is inside a parallel region. Otherwise it is cut into
+		a few chunks per thread (so stealing can even out imbalanced chunks); the calling thread runs the first
+		chunk and helps with the rest until all are done. The first exception thrown by any chunk is rethrown.
+
+		Params:
+			begin, end: the iteration range.
+			fn: callable taking (size_t chunk_begin, size_t chunk_end).
+			grain: the minimum number of iterations per chunk, see grain_for().
+	*/
+	template <typename F>
+	void parallel_for(size_t begin, size_t end, F&& fn, size_t grain = min_parallel_work) {
+		if (end <= begin) {
+			return;
+		}
+		size_t n = end - begin;
+		grain = std::max<size_t>(1, grain);
+		size_t n_threads = get_num_threads();
+
+		if (n_threads <= 1 || n < 2 * grain || detail::in_parallel_region()) {
+			fn(begin, end);
+			return;
+		}
+
+		ThreadPool& pool = ThreadPool::instance();
+		pool.ensure_workers(n_threads - 1);
+		size_t n_chunks = std::min(n / grain, n_threads * 4);
+
+		std::atomic<size_t> remaining{ n_chunks - 1 };
+		std::exception_ptr error;
+		std::mutex error_mutex;
+
+		auto run_chunk = [&](size_t c) {
+			size_t chunk_begin = begin + n * c / n_chunks;
+			size_t chunk_end = begin + n * (c + 1) / n_chunks;
+			try {
+				fn(chunk_begin, chunk_end);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+			}
+		};
+
+		detail::in_parallel_region() = true;
+		for (size_t c = 1; c < n_chunks; ++c) {
+			pool.submit([&, c] {
+				run_chunk(c);
+				remaining.fetch_sub(1, std::memory_order_acq_rel);
+			});
+		}
+		run_chunk(0);
+		while (remaining.load(std::memory_order_acquire) > 0) {
+			if (!pool.try_run_one()) {
+				std::this_thread::yield();
+			}
+		}
+		detail::in_parallel_region() = false;
+
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	/*
+		Parallel reduction over [begin, end).
+
+		The range is cut into blocks of `grain` iterations. map(block_begin, block_end) reduces one block, and
+		the block results are folded with combine(left, right) in a fixed pairwise tree. The blocks and the tree
+		only depend on the range and the grain, never on the thread count, so for a given input the result is
+		the same whether it ran on 1 thread or 64, even for floating point.
+
+		The blocks are mapped in waves of one block per thread, and each wave is folded into the tree before the
+		next one starts, so at most (# threads + log2(# blocks)) block results are alive at a time. That keeps
+		reductions into large results (e.g. one vector or matrix per block) cheap in memory.
+
+		Params:
+			begin, end: the iteration range.
+			identity: the result of an empty range.
+			map: callable taking (size_t block_begin, size_t block_end) and returning an R.
+			combine: callable taking (R left, R right) and returning an R.
+			grain: the number of iterations per block.
+	*/
+	template <typename R, typename Map, typename Combine>
+	R parallel_reduce(size_t begin, size_t end, R identity, Map&& map, Combine&& combine, size_t grain = min_parallel_work) {
+		if (end <= begin) {
+			return identity;
+		}
+		grain = std::max<size_t>(1, grain);
+		size_t n_blocks = (end - begin + grain - 1) / grain;
+		if (n_blocks == 1) {
+			return map(begin, end);
+		}
+
+		// The tree is built like a binary counter: a subtree is merged with its left neighbour as soon as that
+		// one covers as many blocks, and the leftover subtrees are merged right to left at the end. This is the
+		// same tree as pairing up blocks (0, 1), (2, 3), ..., then (01, 23), ..., whatever the wave size.
+		std::vector<std::pair<size_t, R>> subtrees; // (log2 of # blocks, result), left to right.
+		size_t wave_size = std::min(n_blocks, get_num_threads());
+		std::vector<std::optional<R>> wave(wave_size);
+		for (size_t first = 0; first < n_blocks; first += wave_size) {
+			size_t count = std::min(wave_size, n_blocks - first);
+			parallel_for(0, count, [&](size_t block_begin, size_t block_end) {
+				for (size_t b = block_begin; b < block_end; ++b) {
+					size_t lo = begin + (first + b) * grain;
+					size_t hi = std::min(end, lo + grain);
+					wave[b].emplace(map(lo, hi));
+				}
+			}, 1);
+
+			for (size_t b = 0; b < count; ++b) {
+				subtrees.emplace_back(0, std::move(*wave[b]));
+				wave[b].reset();
+				while (subtrees.size() >= 2 && subtrees[subtrees.size() - 2].first == subtrees.back().first) {
+					R merged = combine(subtrees[subtrees.size() - 2].second, subtrees.back().second);
+					subtrees.pop_back();
+					subtrees.back().first += 1;
+					subtrees.back().second = std::move(merged);
+				}
+			}
+		}
+
+		while (subtrees.size() >= 2) {
+			R merged = combine(subtrees[subtrees.size() - 2].second, subtrees.back().second);
+			subtrees.pop_back();
+			subtrees.back().second = std::move(merged);
+		}
+		return std::move(subtrees.back().second);
+	}
+}
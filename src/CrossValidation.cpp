@@ -0,0 +1,135 @@
+#include "BWMLLib/CrossValidation.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "NDArray.hpp"
+#include "ThreadPool.hpp"
+
+namespace BWMLLib {
+	/*
+		Implementation of k-fold cross-validation
+	*/
+
+	KFold::KFold(size_t n_splits, bool shuffle, uint64_t seed) {
+		if (n_splits < 2) {
+			throw std::invalid_argument("KFold needs at least 2 splits!");
+		}
+		this->n_splits = n_splits;
+		this->shuffle = shuffle;
+		this->seed = seed;
+	}
+
+	/*
+		Returns the order in which the rows are dealt out to the folds: the identity, or a seeded shuffle of it.
+	*/
+	std::vector<size_t> KFold::row_order(size_t n_samples) const {
+		if (n_samples < this->n_splits) {
+			throw std::invalid_argument("Cannot have more splits than samples!");
+		}
+		std::vector<size_t> order(n_samples);
+		std::iota(order.begin(), order.end(), size_t(0));
+		if (this->shuffle) {
+			std::mt19937_64 rng(this->seed);
+			std::shuffle(order.begin(), order.end(), rng);
+		}
+		return order;
+	}
+
+	size_t KFold::fold_begin(size_t fold, size_t n_samples) const {
+		return n_samples * fold / this->n_splits;
+	}
+
+	size_t KFold::fold_end(size_t fold, size_t n_samples) const {
+		return n_samples * (fold + 1) / this->n_splits;
+	}
+
+	RowView KFold::train_rows(const std::vector<size_t>& order, size_t fold) const {
+		if (fold >= this->n_splits) {
+			throw std::out_of_range("Fold index out of bounds!");
+		}
+		return RowView::excluding(order, fold_begin(fold, order.size()), fold_end(fold, order.size()));
+	}
+
+	RowView KFold::test_rows(const std::vector<size_t>& order, size_t fold) const {
+		if (fold >= this->n_splits) {
+			throw std::out_of_range("Fold index out of bounds!");
+		}
+		return RowView::slice(order, fold_begin(fold, order.size()), fold_end(fold, order.size()));
+	}
+
+	size_t KFold::get_n_splits() const {
+		return this->n_splits;
+	}
+
+	std::vector<CrossValidationResult> cross_validate(const std::vector<LinReg>& candidates, const NDArray<double>& X,
+		const NDArray<double>& y, const KFold& folds, size_t iterations) {
+		if (X.get_shape().size() != 2) {
+			throw std::invalid_argument("X must be a 2D ndarray of shape (n_samples, n_features)!");
+		}
+		size_t m = X.get_shape()[0];
+		if (y.get_data().size() != m) {
+			throw std::invalid_argument("y must contain exactly one target per row of X!");
+		}
+
+		const std::vector<size_t> order = folds.row_order(m);
+		size_t k = folds.get_n_splits();
+		std::vector<CrossValidationResult> results(candidates.size());
+		for (CrossValidationResult& result : results) {
+			result.folds.resize(k);
+		}
+
+		// A candidate's n_threads of 0 means the caller's thread count. Resolve it here, on the calling thread:
+		// inside a task it would read whatever the worker the task lands on sees, and with it the shard count.
+		size_t default_threads = NDParallel::get_num_threads();
+
+		// One task per (candidate, fold). Grain 1: every task is a whole training run.
+		NDParallel::parallel_for(0, candidates.size() * k, [&](size_t task_begin, size_t task_end) {
+			for (size_t task = task_begin; task < task_end; ++task) {
+				size_t c = task / k;
+				size_t fold = task % k;
+				RowView train = folds.train_rows(order, fold);
+				RowView test = folds.test_rows(order, fold);
+
+				LinReg model = candidates[c];
+				model.set_verbose(false);
+				if (model.get_num_threads() == 0) {
+					model.set_num_threads(default_threads);
+				}
+				model.fit(X, y, train, iterations);
+
+				FoldScore& score = results[c].folds[fold];
+				score.fold = fold;
+				score.n_train = train.size();
+				score.n_test = test.size();
+				score.train_cost = model.compute_cost(X, y, train);
+				score.test_cost = model.compute_cost(X, y, test);
+				score.weights = model.get_weights();
+				score.bias = model.get_biases().get_data()[0];
+			}
+		}, 1);
+
+		for (CrossValidationResult& result : results) {
+			double mean = 0.0;
+			for (const FoldScore& score : result.folds) {
+				mean += score.test_cost / k;
+			}
+			double variance = 0.0;
+			for (const FoldScore& score : result.folds) {
+				variance += (score.test_cost - mean) * (score.test_cost - mean) / k;
+			}
+			result.mean_test_cost = mean;
+			result.std_test_cost = std::sqrt(variance);
+		}
+		return results;
+	}
+
+	CrossValidationResult cross_validate(const LinReg& model, const NDArray<double>& X, const NDArray<double>& y,
+		const KFold& folds, size_t iterations) {
+		return cross_validate(std::vector<LinReg>({ model }), X, y, folds, iterations)[0];
+	}
+
+}
@@ -0,0 +1,388 @@
+#include "BWMLLib/ElasticNet.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "NDArray.hpp"
+#include "ThreadPool.hpp"
+
+namespace BWMLLib {
+	/*
+		Implementation of the elastic net (Ridge / Lasso) path solver
+	*/
+
+	ElasticNet::ElasticNet(double alpha, double l1_ratio, double tol, size_t max_iter) {
+		if (alpha < 0.0) {
+			throw std::invalid_argument("alpha must be non-negative!");
+		}
+		if (l1_ratio < 0.0 || l1_ratio > 1.0) {
+			throw std::invalid_argument("l1_ratio must be within [0, 1]!");
+		}
+		this->alpha = alpha;
+		this->l1_ratio = l1_ratio;
+		this->tol = tol;
+		this->max_iter = max_iter;
+		this->n_samples = 0;
+		this->n_features = 0;
+		this->y_mean = 0.0;
+	}
+
+	/*
+		Offset of row j of a packed upper triangle: row j holds the entries (j, j) ... (j, n - 1).
+	*/
+	size_t ElasticNet::packed_row(size_t j, size_t n_features) {
+		return j * n_features - j * (j - 1) / 2;
+	}
+
+	/*
+		Welford-style update of means and co-moments over the rows [row_begin, row_end).
+		Only the upper triangle of cxx is accumulated (packed, see packed_row()), the caller mirrors it.
+	*/
+	ElasticNet::CoMoments ElasticNet::compute_comoments(const double* X, const double* y, size_t row_begin, size_t row_end, size_t n_features) {
+		CoMoments res;
+		res.x_mean.assign(n_features, 0.0);
+		res.cxx.assign(n_features * (n_features + 1) / 2, 0.0);
+		res.cxy.assign(n_features, 0.0);
+		std::vector<double> delta(n_features);
+
+		for (size_t i = row_begin; i < row_end; ++i) {
+			const double* row = X + i * n_features;
+			res.count += 1;
+			double inv_count = 1.0 / static_cast<double>(res.count);
+
+			for (size_t j = 0; j < n_features; ++j) {
+				delta[j] = row[j] - res.x_mean[j];
+				res.x_mean[j] += delta[j] * inv_count;
+			}
+			double delta_y = y[i] - res.y_mean;
+			res.y_mean += delta_y * inv_count;
+			double dev_y = y[i] - res.y_mean;
+
+			for (size_t j = 0; j < n_features; ++j) {
+				double* cxx_row = res.cxx.data() + packed_row(j, n_features);
+				for (size_t k = j; k < n_features; ++k) {
+					cxx_row[k - j] += delta[j] * (row[k] - res.x_mean[k]);
+				}
+				res.cxy[j] += delta[j] * dev_y;
+			}
+		}
+		return res;
+	}
+
+	/*
+		Chan et al.'s pairwise update for co-moments of two disjoint sets of rows.
+	*/
+	ElasticNet::CoMoments ElasticNet::merge(const CoMoments& a, const CoMoments& b) {
+		if (a.count == 0) {
+			return b;
+		}
+		if (b.count == 0) {
+			return a;
+		}
+
+		size_t n_features = a.x_mean.size();
+		double n_a = static_cast<double>(a.count);
+		double n_b = static_cast<double>(b.count);
+		double n = n_a + n_b;
+		double weight = n_a * n_b / n;
+
+		CoMoments res;
+		res.count = a.count + b.count;
+		res.x_mean.resize(n_features);
+		res.cxx.resize(a.cxx.size());
+		res.cxy.resize(n_features);
+		std::vector<double> delta(n_features);
+		for (size_t j = 0; j < n_features; ++j) {
+			delta[j] = b.x_mean[j] - a.x_mean[j];
+			res.x_mean[j] = a.x_mean[j] + delta[j] * (n_b / n);
+		}
+		double delta_y = b.y_mean - a.y_mean;
+		res.y_mean = a.y_mean + delta_y * (n_b / n);
+
+		for (size_t j = 0; j < n_features; ++j) {
+			size_t row = packed_row(j, n_features);
+			for (size_t k = j; k < n_features; ++k) {
+				size_t at = row + k - j;
+				res.cxx[at] = a.cxx[at] + b.cxx[at] + delta[j] * delta[k] * weight;
+			}
+			res.cxy[j] = a.cxy[j] + b.cxy[j] + delta[j] * delta_y * weight;
+		}
+		return res;
+	}
+
+	/*
+		The one and only pass over the training data. Caches the feature / target means and the centered
+		Gram matrix, everything after this works on the cache.
+	*/
+	void ElasticNet::precompute(const NDArray<double>& X, const NDArray<double>& y) {
+		const std::vector<size_t>& shape = X.get_shape();
+		if (shape.size() != 2) {
+			throw std::invalid_argument("X must be a 2D ndarray of shape (n_samples, n_features)!");
+		}
+		size_t m = shape[0];
+		size_t n = shape[1];
+		if (y.get_data().size() != m) {
+			throw std::invalid_argument("y must contain exactly one target per row of X!");
+		}
+		if (m == 0) {
+			throw std::invalid_argument("Cannot fit on an empty dataset!");
+		}
+
+		const double* x = X.get_data().data();
+		const double* t = y.get_data().data();
+		// Row blocks, see min_block_rows / max_blocks.
+		size_t block_rows = std::max(min_block_rows, (m + max_blocks - 1) / max_blocks);
+		CoMoments total = NDParallel::parallel_reduce(size_t(0), m, CoMoments(),
+			[x, t, n](size_t row_begin, size_t row_end) { return compute_comoments(x, t, row_begin, row_end, n); },
+			[](const CoMoments& a, const CoMoments& b) { return merge(a, b); },
+			block_rows);
+
+		double inv_m = 1.0 / static_cast<double>(m);
+		this->n_samples = m;
+		this->n_features = n;
+		this->x_mean = std::move(total.x_mean);
+		this->y_mean = total.y_mean;
+		this->gram.assign(n * n, 0.0);
+		this->xty.assign(n, 0.0);
+		for (size_t j = 0; j < n; ++j) {
+			for (size_t k = j; k < n; ++k) {
+				double value = total.cxx[packed_row(j, n) + k - j] * inv_m;
+				this->gram[j * n + k] = value;
+				this->gram[k * n + j] = value;
+			}
+			this->xty[j] = total.cxy[j] * inv_m;
+		}
+	}
+
+	bool ElasticNet::is_precomputed() const {
+		return this->n_samples > 0;
+	}
+
+	/*
+		Solves (G + alpha I) w = X^T y / m with a Cholesky factorization G + alpha I = L L^T.
+	*/
+	void ElasticNet::solve_ridge(double alpha, std::vector<double>& w) const {
+		size_t n = this->n_features;
+		std::vector<double> L(n * n, 0.0);
+		for (size_t j = 0; j < n; ++j) {
+			double diagonal = this->gram[j * n + j] + alpha;
+			for (size_t k = 0; k < j; ++k) {
+				diagonal -= L[j * n + k] * L[j * n + k];
+			}
+			if (diagonal <= 0.0) {
+				throw std::runtime_error("The regularized Gram matrix is not positive definite, use a larger alpha!");
+			}
+			L[j * n + j] = std::sqrt(diagonal);
+
+			for (size_t i = j + 1; i < n; ++i) {
+				double value = this->gram[i * n + j];
+				for (size_t k = 0; k < j; ++k) {
+					value -= L[i * n + k] * L[j * n + k];
+				}
+				L[i * n + j] = value / L[j * n + j];
+			}
+		}
+
+		// Forward substitution L z = X^T y / m, then back substitution L^T w = z.
+		std::vector<double> z(n);
+		for (size_t i = 0; i < n; ++i) {
+			double value = this->xty[i];
+			for (size_t k = 0; k < i; ++k) {
+				value -= L[i * n + k] * z[k];
+			}
+			z[i] = value / L[i * n + i];
+		}
+		w.assign(n, 0.0);
+		for (size_t i = n; i-- > 0;) {
+			double value = z[i];
+			for (size_t k = i + 1; k < n; ++k) {
+				value -= L[k * n + i] * w[k];
+			}
+			w[i] = value / L[i * n + i];
+		}
+	}
+
+	/*
+		Covariance-based cyclic coordinate descent, starting from (and overwriting) w.
+		grad holds X^T (y - X w) / m and is updated in O(n) per coordinate step, so a full sweep costs
+		O(n^2) no matter how many rows the data had.
+	*/
+	void ElasticNet::solve_coordinate_descent(double alpha, std::vector<double>& w) const {
+		size_t n = this->n_features;
+		double l1 = alpha * this->l1_ratio;
+		double l2 = alpha * (1.0 - this->l1_ratio);
+
+		std::vector<double> grad(this->xty);
+		for (size_t j = 0; j < n; ++j) {
+			if (w[j] != 0.0) {
+				for (size_t k = 0; k < n; ++k) {
+					grad[k] -= this->gram[k * n + j] * w[j];
+				}
+			}
+		}
+
+		for (size_t iter = 0; iter < this->max_iter; ++iter) {
+			double max_delta = 0.0;
+			double max_weight = 0.0;
+			for (size_t j = 0; j < n; ++j) {
+				double curvature = this->gram[j * n + j] + l2;
+				double updated = 0.0;
+				if (curvature > 0.0) {
+					double rho = grad[j] + this->gram[j * n + j] * w[j];
+					double shrunk = std::max(std::abs(rho) - l1, 0.0);
+					updated = std::copysign(shrunk, rho) / curvature;
+				}
+
+				double delta = updated - w[j];
+				if (delta != 0.0) {
+					for (size_t k = 0; k < n; ++k) {
+						grad[k] -= this->gram[k * n + j] * delta;
+					}
+					w[j] = updated;
+				}
+				max_delta = std::max(max_delta, std::abs(delta));
+				max_weight = std::max(max_weight, std::abs(updated));
+			}
+
+			if (max_delta <= this->tol * std::max(1.0, max_weight)) {
+				return;
+			}
+		}
+	}
+
+	double ElasticNet::intercept(const std::vector<double>& w) const {
+		double res = this->y_mean;
+		for (size_t j = 0; j < w.size(); ++j) {
+			res -= this->x_mean[j] * w[j];
+		}
+		return res;
+	}
+
+	void ElasticNet::fit(const NDArray<double>& X, const NDArray<double>& y) {
+		precompute(X, y);
+		fit();
+	}
+
+	/*
+		Refits at the current alpha from the cached Gram matrix, warm-started from the current weights.
+	*/
+	void ElasticNet::fit() {
+		if (!is_precomputed()) {
+			throw std::logic_error("precompute() must be called before fitting from the cache!");
+		}
+
+		std::vector<double> w(this->n_features, 0.0);
+		if (std::as_const(this->weights).get_data().size() == this->n_features) {
+			w = std::as_const(this->weights).get_data();
+		}
+		if (this->l1_ratio == 0.0) {
+			solve_ridge(this->alpha, w);
+		}
+		else {
+			solve_coordinate_descent(this->alpha, w);
+		}
+
+		double b = intercept(w);
+		this->weights = NDArray<double>({ this->n_features });
+		this->weights.set_data(std::move(w));
+		this->biases = NDArray<double>({ 1 });
+		this->biases.set_data({ b });
+	}
+
+	ElasticNet::RegularizationPath ElasticNet::fit_path(const NDArray<double>& X, const NDArray<double>& y, const std::vector<double>& alphas) {
+		precompute(X, y);
+		return fit_path(alphas);
+	}
+
+	/*
+		Solves for every alpha from the cached Gram matrix. The alphas are visited from the strongest to the
+		weakest penalty, each solve warm-started from the previous one: with L1, the solution moves little between
+		neighbouring alphas, so coordinate descent converges in a few sweeps.
+		The model's own weights and alpha are left untouched.
+	*/
+	ElasticNet::RegularizationPath ElasticNet::fit_path(const std::vector<double>& alphas) {
+		if (!is_precomputed()) {
+			throw std::logic_error("precompute() must be called before fitting from the cache!");
+		}
+		for (double a : alphas) {
+			if (a < 0.0) {
+				throw std::invalid_argument("alpha must be non-negative!");
+			}
+		}
+
+		std::vector<size_t> order(alphas.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return alphas[a] > alphas[b]; });
+
+		RegularizationPath path;
+		path.alphas = alphas;
+		path.weights.resize(alphas.size());
+		path.biases.resize(alphas.size());
+
+		std::vector<double> w(this->n_features, 0.0);
+		for (size_t index : order) {
+			if (this->l1_ratio == 0.0) {
+				solve_ridge(alphas[index], w);
+			}
+			else {
+				solve_coordinate_descent(alphas[index], w);
+			}
+
+			path.biases[index] = intercept(w);
+			path.weights[index] = NDArray<double>({ this->n_features });
+			path.weights[index].set_data(w);
+		}
+		return path;
+	}
+
+	NDArray<double> ElasticNet::predict(const NDArray<double>& X) const {
+		const std::vector<size_t>& shape = X.get_shape();
+		if (shape.size() != 2 || shape[1] != this->weights.get_data().size()) {
+			throw std::invalid_argument("X must be a 2D ndarray of shape (n_samples, n_features)!");
+		}
+
+		size_t m = shape[0];
+		size_t n = shape[1];
+		const double* x = X.get_data().data();
+		const double* w = this->weights.get_data().data();
+		double b = this->biases.get_data()[0];
+
+		std::vector<double> predictions(m);
+		double* out = predictions.data();
+		NDParallel::parallel_for(0, m, [&](size_t row_begin, size_t row_end) {
+			for (size_t i = row_begin; i < row_end; ++i) {
+				double prediction = b;
+				for (size_t j = 0; j < n; ++j) {
+					prediction += x[i * n + j] * w[j];
+				}
+				out[i] = prediction;
+			}
+		}, NDParallel::grain_for(n));
+
+		NDArray<double> res({ m });
+		res.set_data(std::move(predictions));
+		return res;
+	}
+
+	void ElasticNet::set_alpha(double alpha) {
+		if (alpha < 0.0) {
+			throw std::invalid_argument("alpha must be non-negative!");
+		}
+		this->alpha = alpha;
+	}
+
+	double ElasticNet::get_alpha() const {
+		return this->alpha;
+	}
+
+	const NDArray<double>& ElasticNet::get_weights() const {
+		return this->weights;
+	}
+
+	const NDArray<double>& ElasticNet::get_biases() const {
+		return this->biases;
+	}
+
+}
@@ -1,65 +1,322 @@
 #include "BWMLLib/LinReg.h"
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include "NDArray.hpp"
+#include "Reduction.hpp"
+#include "ThreadPool.hpp"
 
 namespace BWMLLib {
 	/*
 		Implementation of Linear Regression algorithm
 	*/
 
-	LinReg::LinReg(double learning_rate, double convergence_tol) {
+	LinReg::LinReg(double learning_rate, double convergence_tol, size_t n_threads) {
 		this->learning_rate = learning_rate;
 		this->convergence_tol = convergence_tol;
+		this->n_threads = n_threads;
+		this->verbose = true;
 	}
 
 	void LinReg::initialize_parameters(int n_features) {
 		this->biases = NDArray<double>({ 1 });
 		this->weights = NDArray<double>({ static_cast<size_t>(n_features) }); // default initializes to zero.
+		this->db = NDArray<double>({ 1 });
+		this->dw = NDArray<double>({ static_cast<size_t>(n_features) });
+	}
+
+	void LinReg::set_num_threads(size_t n_threads) {
+		this->n_threads = n_threads;
+	}
+
+	size_t LinReg::get_num_threads() const {
+		return this->n_threads;
+	}
+
+	/*
+		Resolves the thread-count knob into the actual number of row shards.
+		Never hands out more shards than there are rows, so every worker owns at least one row.
+	*/
+	size_t LinReg::resolve_num_threads(size_t n_rows) const {
+		size_t workers = this->n_threads;
+		if (workers == 0) {
+			workers = NDParallel::get_num_threads();
+		}
+		return std::max<size_t>(1, std::min(workers, n_rows));
 	}
 
 	NDArray<double> BWMLLib::LinReg::forward(const NDArray<double>& X) const {
-		return this->weights.batched_matmul(X) + this->biases;
+		std::vector<size_t> shape = X.get_shape();
+		if (shape.size() != 2 || shape[1] != this->weights.get_data().size()) {
+			throw std::invalid_argument("X must be a 2D ndarray of shape (n_samples, n_features)!");
+		}
+
+		size_t m = shape[0];
+		size_t n = shape[1];
+		const double* x = X.get_data().data();
+		const double* w = this->weights.get_data().data();
+		double b = this->biases.get_data()[0];
+
+		std::vector<double> predictions(m);
+		for (size_t i = 0; i < m; ++i) {
+			double prediction = b;
+			for (size_t j = 0; j < n; ++j) {
+				prediction += x[i * n + j] * w[j];
+			}
+			predictions[i] = prediction;
+		}
+
+		NDArray<double> res({ m });
+		res.set_data(std::move(predictions));
+		return res;
 	}
 
 	double LinReg::compute_cost(NDArray<double> predictions) const {
-		size_t m = predictions.get_size();
-		double cost = (predictions - this->y).square().sum() / m;
+		size_t m = std::as_const(predictions).get_data().size();
+		if (std::as_const(this->y).get_data().empty()) {
+			throw std::logic_error("compute_cost(predictions) needs the targets of a fit(X, y) call!");
+		}
+		if (m != std::as_const(this->y).get_data().size()) {
+			throw std::invalid_argument("The number of predictions does not match the number of targets!");
+		}
+		const double* p = std::as_const(predictions).get_data().data();
+		const double* t = std::as_const(this->y).get_data().data();
+		double cost = NDReduction::transform_sum<double>(m, [p, t](size_t i) { return (p[i] - t[i]) * (p[i] - t[i]); }) / m;
 		return cost;
 	}
 
 	void LinReg::backward(const NDArray<double> predictions) {
-		size_t m = predictions.get_size();
-		this->dw = (predictions - this->y).batched_matmul(this->X) / m;
-		this->db = (predictions - this->y).sum() / m;
+		size_t m = predictions.get_data().size();
+		size_t n = this->weights.get_data().size();
+		if (std::as_const(this->y).get_data().empty()) {
+			throw std::logic_error("backward() needs the data of a fit(X, y) call!");
+		}
+		if (m != std::as_const(this->y).get_data().size()) {
+			throw std::invalid_argument("The number of predictions does not match the number of targets!");
+		}
+		const double* x = std::as_const(this->X).get_data().data();
+		const double* p = predictions.get_data().data();
+		const double* t = std::as_const(this->y).get_data().data();
+
+		std::vector<double> grad_w(n, 0.0);
+		double grad_b = 0.0;
+		for (size_t i = 0; i < m; ++i) {
+			double residual = p[i] - t[i];
+			grad_b += residual;
+			for (size_t j = 0; j < n; ++j) {
+				grad_w[j] += residual * x[i * n + j];
+			}
+		}
+
+		this->dw.set_data(std::move(grad_w));
+		this->db.get_data()[0] = grad_b;
+		this->dw = std::move(this->dw) / m;
+		this->db = std::move(this->db) / m;
+	}
+
+	/*
+		Fused forward + backward pass over the rows rows[row_begin] ... rows[row_end - 1] of (x, t).
+		The prediction of each row is consumed right away, so no full-size prediction or residual
+		arrays are materialized. The results are un-normalized sums, the caller divides by m.
+	*/
+	void LinReg::accumulate_shard(const double* x, const double* t, const RowView& rows, size_t row_begin, size_t row_end, ShardGradient& out) const {
+		size_t n = out.dw.size();
+		const double* w = this->weights.get_data().data();
+		double b = this->biases.get_data()[0];
+		double* grad_w = out.dw.data();
+
+		std::fill(out.dw.begin(), out.dw.end(), 0.0);
+		double grad_b = 0.0;
+		double cost = 0.0;
+		for (size_t i = row_begin; i < row_end; ++i) {
+			size_t r = rows[i];
+			const double* row = x + r * n;
+			double prediction = b;
+			for (size_t j = 0; j < n; ++j) {
+				prediction += row[j] * w[j];
+			}
+
+			double residual = prediction - t[r];
+			cost += residual * residual;
+			grad_b += residual;
+			for (size_t j = 0; j < n; ++j) {
+				grad_w[j] += residual * row[j];
+			}
+		}
+
+		// Written once at the end, so the workers do not bounce these cache lines between cores per row.
+		out.db = grad_b;
+		out.cost = cost;
+	}
+
+	/*
+		Combines the per-worker partials into partials[0] with a fixed-shape binary tree:
+		step 1 adds 1 into 0, 3 into 2, ...; step 2 adds 2 into 0, 6 into 4, ... and so on.
+		The order of the floating point additions only depends on the number of partials, so
+		repeated fits with the same thread count produce bit-identical results.
+	*/
+	void LinReg::tree_reduce(std::vector<ShardGradient>& partials) {
+		for (size_t step = 1; step < partials.size(); step *= 2) {
+			for (size_t i = 0; i + step < partials.size(); i += 2 * step) {
+				ShardGradient& dst = partials[i];
+				const ShardGradient& src = partials[i + step];
+				for (size_t j = 0; j < dst.dw.size(); ++j) {
+					dst.dw[j] += src.dw[j];
+				}
+				dst.db += src.db;
+				dst.cost += src.cost;
+			}
+		}
 	}
 
+	/*
+		Trains the model with data-parallel gradient descent.
+		The rows of X/y are split into one contiguous shard per worker. Each iteration, the shards run the fused
+		forward/backward pass on the shared thread pool, each into its own ShardGradient. The calling thread then
+		reduces the partials, updates the parameters and decides whether to stop. The next gradient depends on
+		the updated weights, so this one join per iteration cannot be removed.
+
+		The shards are fixed by the thread count alone, so the result does not change when the pool runs them on
+		fewer threads (e.g. when fit() is itself called from inside a parallel region).
+	*/
 	void LinReg::fit(NDArray<double>& X, NDArray<double>& y, size_t iterations) {
+		size_t m = validate_data(X, y);
+
 		this->X = std::move(X);
 		this->y = std::move(y);
-		initialize_parameters(this->X.get_shape()[1]);
-		std::vector<double> costs;
+		if (this->y.get_shape().size() != 1) {
+			// Accept column vectors of shape (n_samples, 1) by flattening them.
+			NDArray<double> flat({ m });
+			flat.set_data(std::move(this->y.get_data()));
+			this->y = std::move(flat);
+		}
+		train(std::as_const(this->X).get_data().data(), std::as_const(this->y).get_data().data(), this->X.get_shape()[1], RowView(m), iterations);
+	}
+
+	/*
+		Trains the model on the selected rows of X / y, reading them in place. Neither X nor y are copied or kept
+		by the model, so many models can train on the same (shared, read-only) dataset at once, e.g. the folds of a
+		cross-validation. The caller has to keep X / y alive and unchanged during the call.
+	*/
+	void LinReg::fit(const NDArray<double>& X, const NDArray<double>& y, const RowView& rows, size_t iterations) {
+		size_t m = validate_data(X, y);
+		if (rows.max_row_bound() > m) {
+			throw std::out_of_range("The row selection refers to rows beyond the end of X!");
+		}
+
+		// forward / backward / compute_cost(predictions) refer to the data of the last fit(X, y), which is not this one.
+		this->X = NDArray<double>();
+		this->y = NDArray<double>();
+		train(X.get_data().data(), y.get_data().data(), X.get_shape()[1], rows, iterations);
+	}
+
+	size_t LinReg::validate_data(const NDArray<double>& X, const NDArray<double>& y) {
+		const std::vector<size_t>& x_shape = X.get_shape();
+		if (x_shape.size() != 2) {
+			throw std::invalid_argument("X must be a 2D ndarray of shape (n_samples, n_features)!");
+		}
+		if (y.get_data().size() != x_shape[0]) {
+			throw std::invalid_argument("y must contain exactly one target per row of X!");
+		}
+		return x_shape[0];
+	}
 
+	void LinReg::train(const double* x, const double* t, size_t n, const RowView& rows, size_t iterations) {
+		size_t m = rows.size();
+		initialize_parameters(n);
+		if (iterations == 0 || m == 0) {
+			return;
+		}
+
+		size_t workers = resolve_num_threads(m);
+		NDParallel::ThreadScope scope(workers);
+		std::vector<ShardGradient> partials(workers);
+		for (ShardGradient& partial : partials) {
+			partial.dw.resize(n, 0.0);
+		}
+
+		std::vector<double> costs;
 		for (size_t i = 0; i < iterations; ++i) {
-			NDArray<double> predictions = forward(this->X);
-			double cost = compute_cost(predictions);
-			this->weights = this->weights - this->dw * this->learning_rate;
-			this->biases = this->biases - this->db * this->learning_rate;
+			NDParallel::parallel_for(0, workers, [&](size_t shard_begin, size_t shard_end) {
+				for (size_t w = shard_begin; w < shard_end; ++w) {
+					accumulate_shard(x, t, rows, m * w / workers, m * (w + 1) / workers, partials[w]);
+				}
+			}, 1);
+
+			tree_reduce(partials);
+			const ShardGradient& total = partials[0];
+			this->dw.set_data(total.dw);
+			this->db.get_data()[0] = total.db;
+			this->dw = std::move(this->dw) / m;
+			this->db = std::move(this->db) / m;
+			double cost = total.cost / m;
+
+			this->weights = std::move(this->weights) - this->dw * this->learning_rate;
+			this->biases = std::move(this->biases) - this->db * this->learning_rate;
 			costs.push_back(cost);
 
-			if (i % 100 == 0) {
-				std::cout << "Iteration " << i << ", Cost "<< cost << std::endl;
+			if (this->verbose && i % 100 == 0) {
+				std::cout << "Iteration " << i << ", Cost " << cost << std::endl;
 			}
 
-			if (i > 0 && abs(costs[costs.size() - 1]) - costs[costs.size() - 2] < convergence_tol) {
-				std::cout << "Converged after "<< i << " iterations." << std::endl;
+			if (i > 0 && std::abs(costs[costs.size() - 1] - costs[costs.size() - 2]) < convergence_tol) {
+				if (this->verbose) {
+					std::cout << "Converged after " << i << " iterations." << std::endl;
+				}
+				break;
 			}
 		}
 	}
 
+	/*
+		Returns the mean squared error of the model over the selected rows of X / y, without materializing the
+		predictions. Summed in NDReduction's reproducible mode, like compute_cost().
+	*/
+	double LinReg::compute_cost(const NDArray<double>& X, const NDArray<double>& y, const RowView& rows) const {
+		size_t m = validate_data(X, y);
+		size_t n = X.get_shape()[1];
+		if (n != this->weights.get_data().size()) {
+			throw std::invalid_argument("X must have as many features as the model was trained on!");
+		}
+		if (rows.max_row_bound() > m) {
+			throw std::out_of_range("The row selection refers to rows beyond the end of X!");
+		}
+		if (rows.size() == 0) {
+			return 0.0;
+		}
+
+		const double* x = X.get_data().data();
+		const double* t = y.get_data().data();
+		const double* w = this->weights.get_data().data();
+		double b = this->biases.get_data()[0];
+		double cost = NDReduction::transform_sum<double>(rows.size(), [&](size_t i) {
+			size_t r = rows[i];
+			double prediction = b;
+			for (size_t j = 0; j < n; ++j) {
+				prediction += x[r * n + j] * w[j];
+			}
+			return (prediction - t[r]) * (prediction - t[r]);
+		});
+		return cost / rows.size();
+	}
+
+	void LinReg::set_verbose(bool verbose) {
+		this->verbose = verbose;
+	}
+
 	NDArray<double> LinReg::predict(NDArray<double>& X) const {
 		NDArray<double> prediction = forward(X);
 		return prediction;
 	}
 
-}
\ No newline at end of file
+	const NDArray<double>& LinReg::get_weights() const {
+		return this->weights;
+	}
+
+	const NDArray<double>& LinReg::get_biases() const {
+		return this->biases;
+	}
+
+}
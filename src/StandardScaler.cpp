@@ -0,0 +1,225 @@
+#include "BWMLLib/StandardScaler.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "NDArray.hpp"
+#include "ThreadPool.hpp"
+
+namespace BWMLLib {
+	/*
+		Implementation of the standard scaler
+	*/
+
+	StandardScaler::StandardScaler(bool with_mean, bool with_std) {
+		this->with_mean = with_mean;
+		this->with_std = with_std;
+		this->n_samples_seen = 0;
+	}
+
+	void StandardScaler::reset() {
+		this->n_samples_seen = 0;
+		this->mean = NDArray<double>();
+		this->variance = NDArray<double>();
+		this->scale = NDArray<double>();
+	}
+
+	size_t StandardScaler::n_features_of(const NDArray<double>& X) {
+		if (X.get_shape().size() != 2) {
+			throw std::invalid_argument("X must be a 2D ndarray of shape (n_samples, n_features)!");
+		}
+		return X.get_shape()[1];
+	}
+
+	/*
+		Welford's online algorithm over the rows [row_begin, row_end), one running mean / M2 per feature.
+		Unlike sum / sum-of-squares it does not cancel catastrophically when the mean is large compared to the spread.
+	*/
+	StandardScaler::Moments StandardScaler::compute_moments(const double* X, size_t row_begin, size_t row_end, size_t n_features) {
+		Moments res;
+		res.mean.assign(n_features, 0.0);
+		res.m2.assign(n_features, 0.0);
+		double* mean = res.mean.data();
+		double* m2 = res.m2.data();
+
+		for (size_t i = row_begin; i < row_end; ++i) {
+			const double* row = X + i * n_features;
+			res.count += 1;
+			double inv_count = 1.0 / static_cast<double>(res.count);
+			for (size_t j = 0; j < n_features; ++j) {
+				double delta = row[j] - mean[j];
+				mean[j] += delta * inv_count;
+				m2[j] += delta * (row[j] - mean[j]);
+			}
+		}
+		return res;
+	}
+
+	/*
+		Chan et al.'s pairwise update: combines the moments of two disjoint sets of rows.
+	*/
+	StandardScaler::Moments StandardScaler::merge(const Moments& a, const Moments& b) {
+		if (a.count == 0) {
+			return b;
+		}
+		if (b.count == 0) {
+			return a;
+		}
+
+		Moments res;
+		res.count = a.count + b.count;
+		res.mean.resize(a.mean.size());
+		res.m2.resize(a.m2.size());
+		double n_a = static_cast<double>(a.count);
+		double n_b = static_cast<double>(b.count);
+		double n = static_cast<double>(res.count);
+		for (size_t j = 0; j < a.mean.size(); ++j) {
+			double delta = b.mean[j] - a.mean[j];
+			res.mean[j] = a.mean[j] + delta * (n_b / n);
+			res.m2[j] = a.m2[j] + b.m2[j] + delta * delta * (n_a * n_b / n);
+		}
+		return res;
+	}
+
+	void StandardScaler::fit(const NDArray<double>& X) {
+		reset();
+		partial_fit(X);
+	}
+
+	/*
+		Merges the rows of X into the running statistics. The rows are reduced in parallel blocks whose
+		boundaries only depend on the shape of X, so the result does not depend on the thread count.
+	*/
+	void StandardScaler::partial_fit(const NDArray<double>& X) {
+		size_t n = n_features_of(X);
+		size_t m = X.get_shape()[0];
+		if (this->n_samples_seen > 0 && n != std::as_const(this->mean).get_data().size()) {
+			throw std::invalid_argument("The number of features does not match the previously seen data!");
+		}
+
+		const double* x = X.get_data().data();
+		size_t block_rows = std::max(min_block_rows, (m + max_blocks - 1) / max_blocks);
+		Moments chunk = NDParallel::parallel_reduce(size_t(0), m, Moments(),
+			[x, n](size_t row_begin, size_t row_end) { return compute_moments(x, row_begin, row_end, n); },
+			[](const Moments& a, const Moments& b) { return merge(a, b); },
+			block_rows);
+
+		Moments seen;
+		if (this->n_samples_seen > 0) {
+			const std::vector<double>& seen_mean = std::as_const(this->mean).get_data();
+			const std::vector<double>& seen_variance = std::as_const(this->variance).get_data();
+			seen.count = this->n_samples_seen;
+			seen.mean = seen_mean;
+			seen.m2.resize(n);
+			for (size_t j = 0; j < n; ++j) {
+				seen.m2[j] = seen_variance[j] * static_cast<double>(seen.count);
+			}
+		}
+		Moments total = merge(seen, chunk);
+		if (total.count == 0) {
+			return;
+		}
+
+		std::vector<double> total_variance(n);
+		std::vector<double> total_scale(n);
+		for (size_t j = 0; j < n; ++j) {
+			total_variance[j] = total.m2[j] / static_cast<double>(total.count);
+			double std_dev = std::sqrt(total_variance[j]);
+			// Constant features are left unscaled instead of being divided by zero.
+			total_scale[j] = std_dev > 0.0 ? std_dev : 1.0;
+		}
+
+		this->n_samples_seen = total.count;
+		this->mean = NDArray<double>({ n });
+		this->mean.set_data(std::move(total.mean));
+		this->variance = NDArray<double>({ n });
+		this->variance.set_data(std::move(total_variance));
+		this->scale = NDArray<double>({ n });
+		this->scale.set_data(std::move(total_scale));
+	}
+
+	/*
+		Standardizes X in place: one read and one write of every element, no temporaries.
+	*/
+	void StandardScaler::transform(NDArray<double>& X) const {
+		if (this->n_samples_seen == 0) {
+			throw std::logic_error("The scaler has not been fitted yet!");
+		}
+		size_t n = n_features_of(X);
+		if (n != this->mean.get_data().size()) {
+			throw std::invalid_argument("The number of features does not match the fitted data!");
+		}
+
+		size_t m = X.get_shape()[0];
+		std::vector<double> shift(n, 0.0);
+		std::vector<double> inv_scale(n, 1.0);
+		for (size_t j = 0; j < n; ++j) {
+			if (this->with_mean) {
+				shift[j] = this->mean.get_data()[j];
+			}
+			if (this->with_std) {
+				inv_scale[j] = 1.0 / this->scale.get_data()[j];
+			}
+		}
+
+		double* x = X.get_data().data();
+		NDParallel::parallel_for(0, m, [&](size_t row_begin, size_t row_end) {
+			for (size_t i = row_begin; i < row_end; ++i) {
+				double* row = x + i * n;
+				for (size_t j = 0; j < n; ++j) {
+					row[j] = (row[j] - shift[j]) * inv_scale[j];
+				}
+			}
+		}, NDParallel::grain_for(n));
+	}
+
+	void StandardScaler::fit_transform(NDArray<double>& X) {
+		fit(X);
+		transform(X);
+	}
+
+	/*
+		Undoes transform() in place.
+	*/
+	void StandardScaler::inverse_transform(NDArray<double>& X) const {
+		if (this->n_samples_seen == 0) {
+			throw std::logic_error("The scaler has not been fitted yet!");
+		}
+		size_t n = n_features_of(X);
+		if (n != this->mean.get_data().size()) {
+			throw std::invalid_argument("The number of features does not match the fitted data!");
+		}
+
+		size_t m = X.get_shape()[0];
+		const std::vector<double>& mean = this->mean.get_data();
+		const std::vector<double>& scale = this->scale.get_data();
+		double* x = X.get_data().data();
+		NDParallel::parallel_for(0, m, [&](size_t row_begin, size_t row_end) {
+			for (size_t i = row_begin; i < row_end; ++i) {
+				double* row = x + i * n;
+				for (size_t j = 0; j < n; ++j) {
+					double value = this->with_std ? row[j] * scale[j] : row[j];
+					row[j] = this->with_mean ? value + mean[j] : value;
+				}
+			}
+		}, NDParallel::grain_for(n));
+	}
+
+	const NDArray<double>& StandardScaler::get_mean() const {
+		return this->mean;
+	}
+
+	const NDArray<double>& StandardScaler::get_variance() const {
+		return this->variance;
+	}
+
+	const NDArray<double>& StandardScaler::get_scale() const {
+		return this->scale;
+	}
+
+	size_t StandardScaler::get_n_samples_seen() const {
+		return this->n_samples_seen;
+	}
+
+}
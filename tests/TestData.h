@@ -0,0 +1,26 @@
+#pragma once
+
+#include "NDArray.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/*
+	Shared fixtures for the model tests.
+*/
+
+// y = 2 * x0 - 3 * x1 + 1 + noise * sin(i), sampled on a small deterministic grid.
+inline void make_linear_data(size_t m, NDArray<double>& X, NDArray<double>& y, double noise = 0.0) {
+	std::vector<double> x_data;
+	std::vector<double> y_data;
+	for (size_t i = 0; i < m; ++i) {
+		double x0 = static_cast<double>(i % 7) / 7.0;
+		double x1 = static_cast<double>(i % 5) / 5.0;
+		x_data.insert(x_data.end(), { x0, x1 });
+		y_data.push_back(2.0 * x0 - 3.0 * x1 + 1.0 + noise * std::sin(static_cast<double>(i)));
+	}
+	X = NDArray<double>({ m, 2 });
+	X.set_data(std::move(x_data));
+	y = NDArray<double>({ m });
+	y.set_data(std::move(y_data));
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "BWMLLib/CrossValidation.h"
+#include "BWMLLib/LinReg.h"
+#include "ThreadPool.hpp"
+#include "TestData.h"
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// ============== KFold ==================
+TEST(KFold, FoldsPartitionTheRows) {
+	BWMLLib::KFold folds(4, true, 42);
+	std::vector<size_t> order = folds.row_order(103);
+	std::vector<int> tested(103, 0);
+
+	for (size_t fold = 0; fold < 4; ++fold) {
+		BWMLLib::RowView train = folds.train_rows(order, fold);
+		BWMLLib::RowView test = folds.test_rows(order, fold);
+		EXPECT_EQ(train.size() + test.size(), 103);
+
+		std::vector<int> seen(103, 0);
+		for (size_t i = 0; i < train.size(); ++i) {
+			seen[train[i]] += 1;
+		}
+		for (size_t i = 0; i < test.size(); ++i) {
+			seen[test[i]] += 1;
+			tested[test[i]] += 1;
+		}
+		EXPECT_EQ(seen, std::vector<int>(103, 1));
+	}
+	EXPECT_EQ(tested, std::vector<int>(103, 1));
+
+	EXPECT_EQ(folds.row_order(103), order);
+	EXPECT_NE(BWMLLib::KFold(4, true, 7).row_order(103), order);
+	EXPECT_THROW(BWMLLib::KFold(1), std::invalid_argument);
+	EXPECT_THROW(folds.row_order(3), std::invalid_argument);
+}
+
+// ============== Cross Validation ==================
+TEST(CrossValidation, MatchesFittingEachFoldSeparately) {
+	NDArray<double> X, y;
+	make_linear_data(300, X, y, 0.05);
+	BWMLLib::KFold folds(5, true, 1);
+	BWMLLib::LinReg prototype(0.2, 0.0, 2);
+
+	BWMLLib::CrossValidationResult result = BWMLLib::cross_validate(prototype, X, y, folds, 150);
+	ASSERT_EQ(result.folds.size(), 5);
+
+	std::vector<size_t> order = folds.row_order(300);
+	for (size_t fold = 0; fold < 5; ++fold) {
+		BWMLLib::LinReg model = prototype;
+		model.set_verbose(false);
+		model.fit(std::as_const(X), std::as_const(y), folds.train_rows(order, fold), 150);
+
+		const BWMLLib::FoldScore& score = result.folds[fold];
+		EXPECT_EQ(score.fold, fold);
+		EXPECT_EQ(score.n_train + score.n_test, 300);
+		EXPECT_EQ(score.weights, model.get_weights());
+		EXPECT_EQ(score.test_cost, model.compute_cost(X, y, folds.test_rows(order, fold)));
+		EXPECT_LT(score.test_cost, 0.05);
+	}
+}
+
+TEST(CrossValidation, IndependentOfTheThreadCount) {
+	NDArray<double> X, y;
+	make_linear_data(500, X, y, 0.05);
+	BWMLLib::KFold folds(4);
+	std::vector<BWMLLib::LinReg> candidates({ BWMLLib::LinReg(0.05, 0.0, 2), BWMLLib::LinReg(0.3, 0.0, 2) });
+
+	std::vector<BWMLLib::CrossValidationResult> serial, parallel;
+	{
+		NDParallel::ThreadScope scope(1);
+		serial = BWMLLib::cross_validate(candidates, X, y, folds, 100);
+	}
+	{
+		NDParallel::ThreadScope scope(4);
+		parallel = BWMLLib::cross_validate(candidates, X, y, folds, 100);
+	}
+
+	ASSERT_EQ(parallel.size(), 2);
+	for (size_t c = 0; c < 2; ++c) {
+		for (size_t fold = 0; fold < 4; ++fold) {
+			EXPECT_EQ(serial[c].folds[fold].weights, parallel[c].folds[fold].weights);
+			EXPECT_EQ(serial[c].folds[fold].test_cost, parallel[c].folds[fold].test_cost);
+		}
+		EXPECT_EQ(serial[c].mean_test_cost, parallel[c].mean_test_cost);
+	}
+	// The faster learning rate gets closer in the same number of iterations.
+	EXPECT_LT(parallel[1].mean_test_cost, parallel[0].mean_test_cost);
+}
+
+TEST(CrossValidation, DefaultThreadCountIsResolvedOnce) {
+	NDArray<double> X, y;
+	make_linear_data(300, X, y, 0.05);
+	// Identical candidates that use the caller's thread count: wherever their tasks run, they shard alike.
+	std::vector<BWMLLib::LinReg> candidates(8, BWMLLib::LinReg(0.1, 0.0, 0));
+
+	std::vector<BWMLLib::CrossValidationResult> results;
+	{
+		NDParallel::ThreadScope scope(8);
+		results = BWMLLib::cross_validate(candidates, X, y, BWMLLib::KFold(5), 50);
+	}
+
+	for (size_t c = 1; c < candidates.size(); ++c) {
+		for (size_t fold = 0; fold < 5; ++fold) {
+			EXPECT_EQ(results[c].folds[fold].weights, results[0].folds[fold].weights);
+			EXPECT_EQ(results[c].folds[fold].bias, results[0].folds[fold].bias);
+			EXPECT_EQ(results[c].folds[fold].test_cost, results[0].folds[fold].test_cost);
+		}
+	}
+}
+
+TEST(CrossValidation, SharesTheDatasetAcrossFolds) {
+	NDArray<double> X, y;
+	make_linear_data(400, X, y, 0.05);
+
+	NDArrayStats::reset();
+	BWMLLib::cross_validate(BWMLLib::LinReg(0.1, 0.0, 1), X, y, BWMLLib::KFold(8), 20);
+	EXPECT_EQ(NDArrayStats::deep_copies.load(), 0);
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "Einsum.hpp"
+#include "NDArray.hpp"
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static NDArray<double> make_array(const std::vector<size_t>& shape, double seed) {
+	NDArray<double> res(shape);
+	size_t size = 1;
+	for (size_t dim : shape) {
+		size *= dim;
+	}
+	std::vector<double> data(size);
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = static_cast<double>((i * 7 + static_cast<size_t>(seed * 13)) % 11) - 5.0 + seed;
+	}
+	res.set_data(std::move(data));
+	return res;
+}
+
+// Brute force: loops over every combination of every label.
+static std::vector<double> reference_einsum(const std::vector<std::string>& inputs, const std::string& output,
+	const std::vector<const NDArray<double>*>& operands) {
+	std::map<char, size_t> dims;
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		for (size_t axis = 0; axis < inputs[i].size(); ++axis) {
+			dims[inputs[i][axis]] = operands[i]->get_shape()[axis];
+		}
+	}
+	std::string labels;
+	for (auto& [label, dim] : dims) {
+		labels += label;
+	}
+
+	size_t out_size = 1;
+	for (char label : output) {
+		out_size *= dims[label];
+	}
+	std::vector<double> res(out_size, 0.0);
+	std::map<char, size_t> index;
+	for (char label : labels) {
+		index[label] = 0;
+	}
+	while (true) {
+		double product = 1.0;
+		for (size_t i = 0; i < inputs.size(); ++i) {
+			size_t flat = 0;
+			for (char label : inputs[i]) {
+				flat = flat * dims[label] + index[label];
+			}
+			product *= operands[i]->get_data()[flat];
+		}
+		size_t flat = 0;
+		for (char label : output) {
+			flat = flat * dims[label] + index[label];
+		}
+		res[flat] += product;
+
+		size_t d = labels.size();
+		while (d > 0) {
+			--d;
+			if (++index[labels[d]] < dims[labels[d]]) {
+				break;
+			}
+			index[labels[d]] = 0;
+			if (d == 0) {
+				return res;
+			}
+		}
+		if (labels.empty()) {
+			return res;
+		}
+	}
+}
+
+// ============== Correctness ==================
+TEST(Einsum, MatchesMatmul) {
+	NDArray<double> a = make_array({ 4, 6 }, 1.0);
+	NDArray<double> b = make_array({ 6, 5 }, 2.0);
+	EXPECT_EQ(NDEinsum::einsum("ij,jk->ik", a, b), a.matmul(b));
+	EXPECT_EQ(NDEinsum::einsum("ij,jk", a, b), a.matmul(b));
+}
+
+TEST(Einsum, MatchesBatchedMatmul) {
+	NDArray<double> a = make_array({ 3, 4, 6 }, 1.0);
+	NDArray<double> b = make_array({ 3, 6, 5 }, 2.0);
+	EXPECT_EQ(NDEinsum::einsum("bij,bjk->bik", a, b), a.batched_matmul(b));
+}
+
+TEST(Einsum, PermutedAndMultiOperandSpecsMatchBruteForce) {
+	struct Case {
+		std::vector<std::string> inputs;
+		std::string output;
+		std::vector<std::vector<size_t>> shapes;
+	};
+	std::vector<Case> cases({
+		{ { "bji", "bkj" }, "bik", { { 2, 3, 4 }, { 2, 5, 3 } } },
+		{ { "ijk", "jil" }, "lk", { { 2, 3, 4 }, { 3, 2, 5 } } },
+		{ { "ij", "jk", "kl" }, "il", { { 3, 4 }, { 4, 5 }, { 5, 2 } } },
+		{ { "abc", "cd", "bd" }, "da", { { 2, 3, 4 }, { 4, 5 }, { 3, 5 } } },
+		{ { "i", "j" }, "ij", { { 3 }, { 4 } } },
+		{ { "i", "i" }, "", { { 7 }, { 7 } } },
+		{ { "ii" }, "", { { 4, 4 } } },
+		{ { "ii" }, "i", { { 4, 4 } } },
+		{ { "ijk" }, "kj", { { 2, 3, 4 } } },
+		{ { "ij", "jk" }, "i", { { 3, 4 }, { 4, 5 } } },
+		{ { "bij", "bij" }, "b", { { 2, 3, 4 }, { 2, 3, 4 } } },
+	});
+
+	for (const Case& c : cases) {
+		std::string spec;
+		std::vector<NDArray<double>> arrays;
+		std::vector<const NDArray<double>*> operands;
+		for (size_t i = 0; i < c.inputs.size(); ++i) {
+			spec += (i ? "," : "") + c.inputs[i];
+			arrays.push_back(make_array(c.shapes[i], static_cast<double>(i + 1)));
+		}
+		spec += "->" + c.output;
+		for (const NDArray<double>& arr : arrays) {
+			operands.push_back(&arr);
+		}
+
+		NDArray<double> res = NDEinsum::einsum(spec, operands);
+		EXPECT_EQ(res.get_data(), reference_einsum(c.inputs, c.output, operands)) << spec;
+	}
+}
+
+// ============== Planning ==================
+TEST(EinsumPlan, ContractsTheCheapPairOfAChainFirst) {
+	// (2 x 100) (100 x 2) (2 x 100): the first pair collapses to 2 x 2.
+	std::shared_ptr<const NDEinsum::Plan> left = NDEinsum::plan("ab,bc,cd->ad", { { 2, 100 }, { 100, 2 }, { 2, 100 } });
+	ASSERT_EQ(left->steps.size(), 2);
+	EXPECT_EQ(left->steps[0].lhs, 0);
+	EXPECT_EQ(left->steps[0].rhs, 1);
+	EXPECT_EQ(left->flops, 2 * 100 * 2 + 2 * 2 * 100);
+
+	// (100 x 2) (2 x 100) (100 x 2): the last pair collapses to 2 x 2.
+	std::shared_ptr<const NDEinsum::Plan> right = NDEinsum::plan("ab,bc,cd->ad", { { 100, 2 }, { 2, 100 }, { 100, 2 } });
+	EXPECT_EQ(right->steps[0].lhs, 1);
+	EXPECT_EQ(right->steps[0].rhs, 2);
+	EXPECT_EQ(right->flops, 2 * 100 * 2 + 100 * 2 * 2);
+}
+
+TEST(EinsumPlan, TransposedOperandsAreReadThroughStrides) {
+	// A @ B^T and A^T @ B need no copies, the kernel walks the transposed operand with swapped strides.
+	std::shared_ptr<const NDEinsum::Plan> abt = NDEinsum::plan("ij,kj->ik", { { 3, 4 }, { 5, 4 } });
+	EXPECT_FALSE(abt->steps[0].a.gather.has_value());
+	EXPECT_FALSE(abt->steps[0].b.gather.has_value());
+	EXPECT_FALSE(abt->finish.has_value());
+
+	std::shared_ptr<const NDEinsum::Plan> atb = NDEinsum::plan("ji,jk->ik", { { 4, 3 }, { 4, 5 } });
+	EXPECT_FALSE(atb->steps[0].a.gather.has_value());
+	EXPECT_FALSE(atb->steps[0].b.gather.has_value());
+
+	// Batch axis in the middle of B: the batch is still a single strided axis.
+	std::shared_ptr<const NDEinsum::Plan> middle = NDEinsum::plan("bij,jbk->bik", { { 2, 3, 4 }, { 4, 2, 5 } });
+	EXPECT_FALSE(middle->steps[0].b.gather.has_value());
+
+	NDArray<double> a = make_array({ 3, 4 }, 1.0);
+	NDArray<double> b = make_array({ 5, 4 }, 2.0);
+	EXPECT_EQ(NDEinsum::einsum("ij,kj->ik", a, b), a.matmul(b.transpose(0, 1)));
+}
+
+TEST(EinsumPlan, PlansAreCachedBySpecAndShape) {
+	NDEinsum::PlanCache& cache = NDEinsum::PlanCache::instance();
+	cache.clear();
+
+	NDArray<double> a = make_array({ 4, 6 }, 1.0);
+	NDArray<double> b = make_array({ 6, 5 }, 2.0);
+	NDArray<double> c = make_array({ 6, 2 }, 3.0);
+	NDEinsum::einsum("ij,jk->ik", a, b);
+	NDEinsum::einsum("ij,jk->ik", a, b);
+	EXPECT_EQ(cache.misses(), 1);
+	EXPECT_EQ(cache.hits(), 1);
+
+	NDEinsum::einsum("ij,jk->ik", a, c);
+	NDEinsum::einsum("ij,jk->ki", a, b);
+	EXPECT_EQ(cache.misses(), 3);
+	EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(EinsumPlan, InvalidSpecsThrow) {
+	NDArray<double> a = make_array({ 4, 6 }, 1.0);
+	NDArray<double> b = make_array({ 5, 5 }, 2.0);
+	EXPECT_THROW(NDEinsum::einsum("ij,jk->ik", a), std::invalid_argument);
+	EXPECT_THROW(NDEinsum::einsum("ij,jk->ik", a, b), std::invalid_argument);
+	EXPECT_THROW(NDEinsum::einsum("ijk->i", a), std::invalid_argument);
+	EXPECT_THROW(NDEinsum::einsum("ij->iz", a), std::invalid_argument);
+	EXPECT_THROW(NDEinsum::einsum("ij->ii", a), std::invalid_argument);
+	EXPECT_THROW(NDEinsum::einsum("i1->i", a), std::invalid_argument);
+}
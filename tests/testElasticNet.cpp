@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "BWMLLib/ElasticNet.h"
+#include "ThreadPool.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// y = 3 * x0 - 2 * x1 + 0 * x2 + 5 + small deterministic noise.
+static void make_sparse_data(size_t m, NDArray<double>& X, NDArray<double>& y) {
+	std::vector<double> x_data;
+	std::vector<double> y_data;
+	for (size_t i = 0; i < m; ++i) {
+		double x0 = std::sin(static_cast<double>(i) * 0.37);
+		double x1 = std::cos(static_cast<double>(i) * 0.11) + 100.0;
+		double x2 = static_cast<double>((i * 7) % 13) / 13.0;
+		x_data.insert(x_data.end(), { x0, x1, x2 });
+		y_data.push_back(3.0 * x0 - 2.0 * x1 + 5.0 + 0.01 * std::sin(static_cast<double>(i) * 1.7));
+	}
+	X = NDArray<double>({ m, 3 });
+	X.set_data(std::move(x_data));
+	y = NDArray<double>({ m });
+	y.set_data(std::move(y_data));
+}
+
+static double mean_squared_error(const NDArray<double>& predictions, const NDArray<double>& y) {
+	double mse = 0.0;
+	const std::vector<double>& p = predictions.get_data();
+	const std::vector<double>& t = y.get_data();
+	for (size_t i = 0; i < p.size(); ++i) {
+		mse += (p[i] - t[i]) * (p[i] - t[i]) / p.size();
+	}
+	return mse;
+}
+
+// ============== Ridge ==================
+TEST(Ridge, NearlyUnregularizedMatchesLeastSquares) {
+	NDArray<double> X, y;
+	make_sparse_data(2000, X, y);
+
+	BWMLLib::Ridge model(1e-10);
+	model.fit(X, y);
+
+	const std::vector<double>& w = model.get_weights().get_data();
+	EXPECT_NEAR(w[0], 3.0, 1e-2);
+	EXPECT_NEAR(w[1], -2.0, 1e-2);
+	EXPECT_NEAR(w[2], 0.0, 1e-2);
+	EXPECT_LT(mean_squared_error(model.predict(X), y), 1e-3);
+}
+
+TEST(Ridge, SatisfiesNormalEquations) {
+	NDArray<double> X, y;
+	make_sparse_data(500, X, y);
+	const std::vector<double>& x = X.get_data();
+	const std::vector<double>& t = y.get_data();
+
+	double alpha = 0.3;
+	BWMLLib::Ridge model(alpha);
+	model.fit(X, y);
+	NDArray<double> predictions = model.predict(X);
+	const std::vector<double>& p = std::as_const(predictions).get_data();
+
+	// The gradient of the objective vanishes: X^T (y - p) / m = alpha * w, and the residuals sum to zero.
+	double residual_sum = 0.0;
+	for (size_t j = 0; j < 3; ++j) {
+		double correlation = 0.0;
+		for (size_t i = 0; i < 500; ++i) {
+			correlation += x[i * 3 + j] * (t[i] - p[i]) / 500;
+		}
+		EXPECT_NEAR(correlation, alpha * model.get_weights().get_data()[j], 1e-8);
+	}
+	for (size_t i = 0; i < 500; ++i) {
+		residual_sum += t[i] - p[i];
+	}
+	EXPECT_NEAR(residual_sum, 0.0, 1e-8);
+}
+
+TEST(Ridge, SingularWithoutRegularizationThrows) {
+	NDArray<double> X({ 4, 2 });
+	X.set_data({ 1, 2, 2, 4, 3, 6, 4, 8 }); // second column = 2 * first column.
+	NDArray<double> y({ 4 });
+	y.set_data({ 1, 2, 3, 4 });
+
+	BWMLLib::Ridge model(0.0);
+	EXPECT_THROW(model.fit(X, y), std::runtime_error);
+}
+
+// ============== Lasso ==================
+TEST(Lasso, LargeAlphaZeroesAllWeights) {
+	NDArray<double> X, y;
+	make_sparse_data(500, X, y);
+
+	BWMLLib::Lasso model(1e3);
+	model.fit(X, y);
+	for (double w : model.get_weights().get_data()) {
+		EXPECT_EQ(w, 0.0);
+	}
+	// With every weight at zero the intercept is just the mean target.
+	double y_mean = 0.0;
+	for (double t : std::as_const(y).get_data()) {
+		y_mean += t / 500;
+	}
+	EXPECT_NEAR(model.get_biases().get_data()[0], y_mean, 1e-9);
+}
+
+TEST(Lasso, SelectsTheRelevantFeatures) {
+	NDArray<double> X, y;
+	make_sparse_data(2000, X, y);
+
+	BWMLLib::Lasso model(0.01);
+	model.fit(X, y);
+	const std::vector<double>& w = model.get_weights().get_data();
+	EXPECT_NEAR(w[0], 3.0, 0.05);
+	EXPECT_NEAR(w[1], -2.0, 0.1);
+	EXPECT_EQ(w[2], 0.0);
+}
+
+// ============== Regularization Path ==================
+TEST(RegularizationPath, MatchesIndividualFits) {
+	NDArray<double> X, y;
+	make_sparse_data(1000, X, y);
+	std::vector<double> alphas({ 0.001, 1.0, 0.1, 0.01 });
+
+	BWMLLib::ElasticNet path_model(1.0, 0.5);
+	BWMLLib::ElasticNet::RegularizationPath path = path_model.fit_path(X, y, alphas);
+	ASSERT_EQ(path.weights.size(), alphas.size());
+
+	for (size_t a = 0; a < alphas.size(); ++a) {
+		BWMLLib::ElasticNet single(alphas[a], 0.5);
+		single.fit(X, y);
+		for (size_t j = 0; j < 3; ++j) {
+			EXPECT_NEAR(path.weights[a].get_data()[j], single.get_weights().get_data()[j], 1e-6);
+		}
+		EXPECT_NEAR(path.biases[a], single.get_biases().get_data()[0], 1e-5);
+	}
+}
+
+TEST(RegularizationPath, CachedGramIsReusedAndThreadIndependent) {
+	NDArray<double> X, y;
+	make_sparse_data(100000, X, y);
+
+	BWMLLib::Ridge serial_model, parallel_model;
+	{
+		NDParallel::ThreadScope scope(1);
+		serial_model.precompute(X, y);
+	}
+	{
+		NDParallel::ThreadScope scope(4);
+		parallel_model.precompute(X, y);
+	}
+
+	// No X / y from here on: the whole grid comes out of the cache.
+	std::vector<double> alphas({ 10.0, 1.0, 0.1 });
+	BWMLLib::ElasticNet::RegularizationPath serial = serial_model.fit_path(alphas);
+	BWMLLib::ElasticNet::RegularizationPath parallel = parallel_model.fit_path(alphas);
+	for (size_t a = 0; a < alphas.size(); ++a) {
+		EXPECT_EQ(serial.weights[a], parallel.weights[a]);
+		EXPECT_EQ(serial.biases[a], parallel.biases[a]);
+	}
+
+	// Stronger penalties shrink the weights.
+	EXPECT_LT(std::abs(serial.weights[0].get_data()[0]), std::abs(serial.weights[2].get_data()[0]));
+}
+
+TEST(RegularizationPath, RequiresPrecompute) {
+	BWMLLib::Lasso model;
+	EXPECT_THROW(model.fit_path(std::vector<double>({ 1.0 })), std::logic_error);
+	EXPECT_THROW(model.fit(), std::logic_error);
+	EXPECT_THROW(BWMLLib::ElasticNet(1.0, 1.5), std::invalid_argument);
+}
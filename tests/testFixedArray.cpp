@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "FixedArray.hpp"
+#include "NDArray.hpp"
+#include <array>
+#include <vector>
+#include <stdexcept>
+
+// ============== FixedArray Construction =================
+TEST(FixedArrayConstruction, ShapeAndStrides) {
+	using Tensor = FixedArray<int, 3, 4, 2>;
+	static_assert(Tensor::size == 24);
+	static_assert(Tensor::rank == 3);
+	static_assert(Tensor::strides == std::array<size_t, 3>({ 8, 2, 1 }));
+	static_assert(sizeof(Tensor) == 24 * sizeof(int)); // no heap metadata at all.
+
+	Tensor t;
+	for (int v : t.get_data()) {
+		EXPECT_EQ(v, 0);
+	}
+}
+
+TEST(FixedArrayConstruction, Indexing) {
+	Mat2<int> m({ 1, 2, 3, 4 });
+	EXPECT_EQ(m(0, 0), 1);
+	EXPECT_EQ(m(0, 1), 2);
+	EXPECT_EQ(m(1, 0), 3);
+	m(1, 1) = 7;
+	EXPECT_EQ(m[3], 7);
+}
+
+TEST(FixedArrayConstruction, NDArrayRoundTrip) {
+	NDArray<int> nd({ 2, 3 });
+	nd.set_data({ 1, 2, 3, 4, 5, 6 });
+
+	FixedArray<int, 2, 3> fixed(nd);
+	EXPECT_EQ(fixed(1, 2), 6);
+
+	NDArray<int> back = fixed.to_ndarray();
+	EXPECT_EQ(back.get_shape(), std::vector<size_t>({ 2, 3 }));
+	EXPECT_EQ(back.get_data(), nd.get_data());
+}
+
+TEST(FixedArrayConstruction, NDArrayShapeUnmatch) {
+	NDArray<int> nd({ 3, 2 });
+	EXPECT_THROW((FixedArray<int, 2, 3>(nd)), std::invalid_argument);
+}
+
+// ============== FixedArray Math Operations =================
+TEST(FixedArrayMath, Elementwise) {
+	Vec4<int> a({ 1, 2, 3, 4 });
+	Vec4<int> b({ 4, 3, 2, 1 });
+
+	EXPECT_EQ((a + b).get_data(), (std::array<int, 4>({ 5, 5, 5, 5 })));
+	EXPECT_EQ((a - b).get_data(), (std::array<int, 4>({ -3, -1, 1, 3 })));
+	EXPECT_EQ((a * 2).get_data(), (std::array<int, 4>({ 2, 4, 6, 8 })));
+	EXPECT_EQ((b / 2).get_data(), (std::array<int, 4>({ 2, 1, 1, 0 })));
+	EXPECT_EQ(a.hadamard(b).get_data(), (std::array<int, 4>({ 4, 6, 6, 4 })));
+	EXPECT_EQ(a.square().get_data(), (std::array<int, 4>({ 1, 4, 9, 16 })));
+}
+
+TEST(FixedArrayMath, Reductions) {
+	Vec3<double> v({ 1.0, 2.0, 2.0 });
+	EXPECT_DOUBLE_EQ(v.sum(), 5.0);
+	EXPECT_DOUBLE_EQ(v.dot(v), 9.0);
+	EXPECT_DOUBLE_EQ(v.square_root()[2], std::sqrt(2.0));
+}
+
+TEST(FixedArrayMath, ConstexprEvaluation) {
+	constexpr Mat2<int> m({ 1, 2, 3, 4 });
+	constexpr Mat2<int> sq = m.matmul(m);
+	static_assert(sq.get_data() == std::array<int, 4>({ 7, 10, 15, 22 }));
+	static_assert(m.sum() == 10);
+	static_assert(Mat3<int>::identity().sum() == 3);
+}
+
+// ============== FixedArray Matrix Multiplication =================
+TEST(FixedArrayMatmul, MatchesNDArray) {
+	FixedArray<int, 3, 4> a({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 });
+	FixedArray<int, 4, 5> b({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 });
+
+	FixedArray<int, 3, 5> res = a.matmul(b);
+	NDArray<int> expected = a.to_ndarray().matmul(b.to_ndarray());
+	EXPECT_EQ(res.to_ndarray().get_data(), expected.get_data());
+}
+
+TEST(FixedArrayMatmul, IdentityAndTranspose) {
+	Mat4<float> m;
+	for (size_t i = 0; i < Mat4<float>::size; ++i) {
+		m[i] = static_cast<float>(i);
+	}
+	EXPECT_EQ(m.matmul(Mat4<float>::identity()), m);
+	EXPECT_EQ(m.transpose().transpose(), m);
+
+	FixedArray<int, 2, 3> r({ 1, 2, 3, 4, 5, 6 });
+	FixedArray<int, 3, 2> rt = r.transpose();
+	EXPECT_EQ(rt.get_data(), (std::array<int, 6>({ 1, 4, 2, 5, 3, 6 })));
+}
+
+TEST(FixedArrayMatmul, MatrixVector) {
+	Mat3<double> m({ 1, 0, 0, 0, 2, 0, 0, 0, 3 });
+	Vec3<double> v({ 1, 1, 1 });
+	EXPECT_EQ(m.matmul(v).get_data(), (std::array<double, 3>({ 1, 2, 3 })));
+}
+
+TEST(FixedArrayMatmul, LargeShapeFallsBackToLoops) {
+	FixedArray<int, 16, 16> a = FixedArray<int, 16, 16>::filled(1);
+	FixedArray<int, 16, 16> res = a.matmul(a);
+	EXPECT_EQ(res(3, 7), 16);
+	EXPECT_EQ(res.sum(), 16 * 16 * 16);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "BWMLLib/LinReg.h"
+#include "TestData.h"
+#include <vector>
+#include <stdexcept>
+#include <utility>
+
+// ============== LinReg Training ==================
+TEST(LinRegTraining, RecoversLinearModel) {
+	NDArray<double> X, y;
+	make_linear_data(350, X, y);
+
+	BWMLLib::LinReg model(0.5, 1e-14);
+	model.fit(X, y, 20000);
+
+	const std::vector<double>& w = model.get_weights().get_data();
+	EXPECT_NEAR(w[0], 2.0, 1e-3);
+	EXPECT_NEAR(w[1], -3.0, 1e-3);
+	EXPECT_NEAR(model.get_biases().get_data()[0], 1.0, 1e-3);
+}
+
+TEST(LinRegTraining, DeterministicForFixedThreadCount) {
+	NDArray<double> X1, y1, X2, y2;
+	make_linear_data(1001, X1, y1);
+	make_linear_data(1001, X2, y2);
+
+	BWMLLib::LinReg first(0.1, 0.0, 4);
+	BWMLLib::LinReg second(0.1, 0.0, 4);
+	first.fit(X1, y1, 300);
+	second.fit(X2, y2, 300);
+
+	EXPECT_EQ(first.get_weights().get_data(), second.get_weights().get_data());
+	EXPECT_EQ(first.get_biases().get_data(), second.get_biases().get_data());
+}
+
+TEST(LinRegTraining, ParallelMatchesSerial) {
+	NDArray<double> X1, y1, X2, y2;
+	make_linear_data(1001, X1, y1);
+	make_linear_data(1001, X2, y2);
+
+	BWMLLib::LinReg serial(0.1, 0.0, 1);
+	BWMLLib::LinReg parallel(0.1, 0.0, 3);
+	serial.fit(X1, y1, 300);
+	parallel.fit(X2, y2, 300);
+
+	for (size_t j = 0; j < 2; ++j) {
+		EXPECT_NEAR(serial.get_weights().get_data()[j], parallel.get_weights().get_data()[j], 1e-9);
+	}
+	EXPECT_NEAR(serial.get_biases().get_data()[0], parallel.get_biases().get_data()[0], 1e-9);
+}
+
+TEST(LinRegTraining, MoreThreadsThanRows) {
+	NDArray<double> X, y;
+	make_linear_data(3, X, y);
+
+	BWMLLib::LinReg model(0.1, 0.0, 16);
+	EXPECT_NO_THROW(model.fit(X, y, 10));
+}
+
+TEST(LinRegTraining, RowCountMismatch) {
+	NDArray<double> X({ 4, 2 });
+	NDArray<double> y({ 3 });
+
+	BWMLLib::LinReg model(0.1);
+	EXPECT_THROW(model.fit(X, y, 10), std::invalid_argument);
+}
+
+TEST(LinRegTraining, PredictShape) {
+	NDArray<double> X, y, X_test, y_test;
+	make_linear_data(50, X, y);
+	make_linear_data(10, X_test, y_test);
+
+	BWMLLib::LinReg model(0.1, 0.0, 2);
+	model.fit(X, y, 5);
+
+	NDArray<double> predictions = model.predict(X_test);
+	EXPECT_EQ(predictions.get_shape(), std::vector<size_t>({ 10 }));
+}
+
+TEST(LinRegTraining, CostAndBackwardDoNotCopyPredictions) {
+	NDArray<double> X, y;
+	make_linear_data(100, X, y);
+	NDArray<double> X_copy = X;
+
+	BWMLLib::LinReg model(0.1, 0.0, 2);
+	model.fit(X, y, 5);
+	NDArray<double> predictions = model.forward(X_copy);
+
+	NDArrayStats::reset();
+	model.compute_cost(predictions);
+	model.backward(predictions);
+	EXPECT_EQ(NDArrayStats::deep_copies.load(), 0);
+}
+
+TEST(LinRegTraining, CostAndBackwardWithoutOwnedDataThrow) {
+	NDArray<double> X, y;
+	make_linear_data(20, X, y);
+	NDArray<double> predictions({ 20 });
+
+	// Never fitted.
+	BWMLLib::LinReg model(0.1, 0.0, 2);
+	EXPECT_THROW(model.compute_cost(predictions), std::logic_error);
+	EXPECT_THROW(model.backward(predictions), std::logic_error);
+
+	// fit() on a RowView reads X / y in place and keeps no targets.
+	model.fit(std::as_const(X), std::as_const(y), BWMLLib::RowView(4), 5);
+	EXPECT_THROW(model.compute_cost(model.forward(X)), std::logic_error);
+	EXPECT_THROW(model.compute_cost(NDArray<double>()), std::logic_error);
+	EXPECT_THROW(model.backward(model.forward(X)), std::logic_error);
+
+	// Once the model owns data again, mismatched predictions are rejected.
+	NDArray<double> X_owned = X, y_owned = y;
+	model.fit(X_owned, y_owned, 5);
+	EXPECT_THROW(model.backward(NDArray<double>({ 3 })), std::invalid_argument);
+	EXPECT_THROW(model.compute_cost(NDArray<double>({ 3 })), std::invalid_argument);
+}
+
+TEST(LinRegTraining, FitOnRowViewMatchesFitOnCopiedRows) {
+	NDArray<double> X, y;
+	make_linear_data(200, X, y);
+	const std::vector<double>& x_data = std::as_const(X).get_data();
+	const std::vector<double>& y_data = std::as_const(y).get_data();
+
+	// Every third row, read in place vs. copied out.
+	std::vector<size_t> rows;
+	std::vector<double> x_subset, y_subset;
+	for (size_t i = 0; i < 200; i += 3) {
+		rows.push_back(i);
+		x_subset.insert(x_subset.end(), { x_data[i * 2], x_data[i * 2 + 1] });
+		y_subset.push_back(y_data[i]);
+	}
+	NDArray<double> X_subset({ rows.size(), 2 });
+	X_subset.set_data(std::move(x_subset));
+	NDArray<double> y_subset_arr({ rows.size() });
+	y_subset_arr.set_data(std::move(y_subset));
+
+	BWMLLib::LinReg view_model(0.1, 0.0, 2);
+	BWMLLib::LinReg copy_model(0.1, 0.0, 2);
+	// fit(X, y, iterations) takes the data over, keep (shared) copies for scoring.
+	NDArray<double> X_subset_copy = X_subset;
+	NDArray<double> y_subset_copy = y_subset_arr;
+	view_model.fit(std::as_const(X), std::as_const(y), BWMLLib::RowView(rows), 200);
+	copy_model.fit(X_subset, y_subset_arr, 200);
+
+	EXPECT_EQ(view_model.get_weights(), copy_model.get_weights());
+	EXPECT_EQ(view_model.get_biases(), copy_model.get_biases());
+	EXPECT_EQ(view_model.compute_cost(X, y, BWMLLib::RowView(rows)),
+		copy_model.compute_cost(X_subset_copy, y_subset_copy, BWMLLib::RowView(rows.size())));
+
+	// The dataset is left untouched and not retained.
+	EXPECT_EQ(X.get_shape(), std::vector<size_t>({ 200, 2 }));
+	std::vector<size_t> out_of_range({ 0, 200 });
+	EXPECT_THROW(view_model.fit(std::as_const(X), std::as_const(y), BWMLLib::RowView(out_of_range), 10), std::out_of_range);
+}
@@ -2,6 +2,7 @@
 #include "NDArray.hpp"
 #include <vector>
 #include <stdexcept>
+#include <utility>
 
 TEST(SanityCheck, BasicMath) {
 	EXPECT_EQ(1 + 1, 2);
@@ -80,6 +81,35 @@ TEST(NDArrayInternalProperties, NDTranspose) {
 	EXPECT_EQ(res.get_strides(), res_strides);
 }
 
+TEST(NDArrayInternalProperties, TransposeMovesData) {
+	NDArray<int> m1({ 2, 3 });
+	m1.set_data({ 1, 2, 3, 4, 5, 6 });
+	NDArray<int> res = m1.transpose(0, 1);
+	EXPECT_EQ(res.get_data(), std::vector<int>({ 1, 4, 2, 5, 3, 6 }));
+	EXPECT_THROW(m1.transpose(0, 2), std::out_of_range);
+}
+
+TEST(NDArrayInternalProperties, Permute) {
+	NDArray<int> m1({ 2, 3, 4 });
+	std::vector<int> data(24);
+	for (int i = 0; i < 24; ++i) {
+		data[i] = i;
+	}
+	m1.set_data(data);
+
+	NDArray<int> res = m1.permute({ 2, 0, 1 });
+	EXPECT_EQ(res.get_shape(), std::vector<size_t>({ 4, 2, 3 }));
+	for (size_t i = 0; i < 2; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			for (size_t k = 0; k < 4; ++k) {
+				EXPECT_EQ(res({ k, i, j }), m1({ i, j, k }));
+			}
+		}
+	}
+	EXPECT_THROW(m1.permute({ 0, 0, 1 }), std::invalid_argument);
+	EXPECT_THROW(m1.permute({ 0, 1 }), std::invalid_argument);
+}
+
 TEST(NDArrayInternalProperties, squaring) {
 	NDArray<int> m1({ 2, 2 });
 	NDArray<float> m2({2, 1});
@@ -260,3 +290,141 @@ TEST(BatchedMatrixMultiplication, ShapeUnmatchCase3) {
 	NDArray<int> m2({ 3, 2, 3 });
 	EXPECT_THROW(m1.batched_matmul(m2), std::invalid_argument);
 }
+
+
+// ============== Copy-On-Write ======================
+TEST(CopyOnWrite, CopiesShareBuffer) {
+	NDArray<int> m1({ 2, 3 });
+	m1.set_data({ 1, 2, 3, 4, 5, 6 });
+
+	NDArrayStats::reset();
+	NDArray<int> m2(m1);
+	NDArray<int> m3;
+	m3 = m1;
+
+	EXPECT_TRUE(m2.shares_data_with(m1));
+	EXPECT_TRUE(m3.shares_data_with(m1));
+	EXPECT_EQ(NDArrayStats::shared_copies.load(), 2);
+	EXPECT_EQ(NDArrayStats::deep_copies.load(), 0);
+	EXPECT_EQ(m2, m1);
+}
+
+TEST(CopyOnWrite, FirstWriteDetaches) {
+	NDArray<int> m1({ 2, 2 });
+	m1.set_data({ 1, 2, 3, 4 });
+	NDArray<int> m2 = m1;
+
+	NDArrayStats::reset();
+	m2(std::vector<size_t>{ 0, 0 }) = 9;
+
+	EXPECT_EQ(NDArrayStats::deep_copies.load(), 1);
+	EXPECT_FALSE(m2.shares_data_with(m1));
+	EXPECT_EQ(m1.get_data(), std::vector<int>({ 1, 2, 3, 4 }));
+	EXPECT_EQ(m2.get_data(), std::vector<int>({ 9, 2, 3, 4 }));
+}
+
+TEST(CopyOnWrite, SetDataOnSharedArrayDoesNotCopy) {
+	NDArray<int> m1({ 2, 2 });
+	m1.set_data({ 1, 2, 3, 4 });
+	NDArray<int> m2 = m1;
+
+	NDArrayStats::reset();
+	m2.set_data({ 5, 6, 7, 8 });
+
+	EXPECT_EQ(NDArrayStats::deep_copies.load(), 0);
+	EXPECT_EQ(std::as_const(m1).get_data(), std::vector<int>({ 1, 2, 3, 4 }));
+	EXPECT_EQ(std::as_const(m2).get_data(), std::vector<int>({ 5, 6, 7, 8 }));
+}
+
+TEST(CopyOnWrite, MutableReferenceMakesCopiesDeep) {
+	NDArray<int> m1({ 2, 2 });
+	m1.set_data({ 1, 2, 3, 4 });
+	std::vector<int>& ref = m1.get_data();
+
+	NDArray<int> m2 = m1;
+	ref[0] = 42;
+
+	EXPECT_FALSE(m2.shares_data_with(m1));
+	EXPECT_EQ(std::as_const(m2).get_data(), std::vector<int>({ 1, 2, 3, 4 }));
+	EXPECT_EQ(std::as_const(m1).get_data(), std::vector<int>({ 42, 2, 3, 4 }));
+}
+
+TEST(CopyOnWrite, OperatorsOnlyReadSharedBuffers) {
+	NDArray<double> m1({ 3 });
+	m1.set_data({ 1.0, 2.0, 3.0 });
+	NDArray<double> m2 = m1;
+
+	NDArrayStats::reset();
+	NDArray<double> res = (m1 - m2).square();
+
+	EXPECT_EQ(NDArrayStats::deep_copies.load(), 0);
+	EXPECT_EQ(res.sum(), 0.0);
+}
+
+
+// ============== Move Semantics & Buffer Reuse ======================
+TEST(MoveSemantics, MoveIsConstantTime) {
+	NDArray<int> m1({ 2, 3 });
+	m1.set_data({ 1, 2, 3, 4, 5, 6 });
+	const int* address = std::as_const(m1).get_data().data();
+
+	NDArrayStats::reset();
+	NDArray<int> m2(std::move(m1));
+
+	EXPECT_EQ(NDArrayStats::buffer_allocations.load(), 0);
+	EXPECT_EQ(NDArrayStats::deep_copies.load(), 0);
+	EXPECT_EQ(std::as_const(m2).get_data().data(), address);
+	EXPECT_EQ(m2.get_shape(), std::vector<size_t>({ 2, 3 }));
+	EXPECT_TRUE(m1.get_shape().empty());
+}
+
+TEST(MoveSemantics, MoveAssignmentOfEqualArrayTakesItsBuffer) {
+	NDArray<int> m1({ 2 });
+	NDArray<int> m2({ 2 });
+	NDArray<int> witness = m2;
+
+	m1 = std::move(m2);
+	EXPECT_TRUE(m1.shares_data_with(witness));
+}
+
+TEST(MoveSemantics, RvalueChainsReuseOneBuffer) {
+	NDArray<double> a({ 4 });
+	NDArray<double> b({ 4 });
+	a.set_data({ 4.0, 6.0, 8.0, 10.0 });
+	b.set_data({ 1.0, 2.0, 3.0, 4.0 });
+
+	NDArrayStats::reset();
+	NDArray<double> res = (a - b).square();
+	EXPECT_EQ(NDArrayStats::buffer_allocations.load(), 1);
+	EXPECT_EQ(std::as_const(res).get_data(), std::vector<double>({ 9.0, 16.0, 25.0, 36.0 }));
+
+	NDArrayStats::reset();
+	NDArray<double> chained = ((a + b) * 2.0 - b).square_root() / 1.0;
+	EXPECT_EQ(NDArrayStats::buffer_allocations.load(), 1);
+	EXPECT_DOUBLE_EQ(std::as_const(chained).get_data()[0], 3.0);
+
+	NDArrayStats::reset();
+	NDArray<double> rhs_reuse = a - (b * 2.0);
+	EXPECT_EQ(NDArrayStats::buffer_allocations.load(), 1);
+	EXPECT_EQ(std::as_const(rhs_reuse).get_data(), std::vector<double>({ 2.0, 2.0, 2.0, 2.0 }));
+}
+
+TEST(MoveSemantics, SharedTemporariesAreNotOverwritten) {
+	NDArray<int> a({ 3 });
+	NDArray<int> b({ 3 });
+	a.set_data({ 1, 2, 3 });
+	b.set_data({ 1, 1, 1 });
+
+	NDArray<int> alias = a;
+	NDArray<int> res = std::move(alias) + b;
+
+	EXPECT_EQ(std::as_const(a).get_data(), std::vector<int>({ 1, 2, 3 }));
+	EXPECT_EQ(std::as_const(res).get_data(), std::vector<int>({ 2, 3, 4 }));
+}
+
+TEST(MoveSemantics, RvalueShapeUnmatch) {
+	NDArray<int> a({ 3 });
+	NDArray<int> b({ 2 });
+	EXPECT_THROW(NDArray<int>({ 3 }) - b, std::invalid_argument);
+	EXPECT_THROW(a + NDArray<int>({ 2 }), std::invalid_argument);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "NDIter.hpp"
+#include "NDArray.hpp"
+#include "ThreadPool.hpp"
+#include <array>
+#include <vector>
+
+// ============== Layout Normalization ==================
+TEST(NDIter, DenseArraysCoalesceIntoOneDimension) {
+	std::vector<size_t> shape({ 4, 1, 5, 6 });
+	NDIter::Iterator<2> it(shape, { NDIter::dense_strides(shape), NDIter::dense_strides(shape) });
+	EXPECT_EQ(it.get_shape(), std::vector<size_t>({ 120 }));
+	EXPECT_TRUE(it.inner_contiguous());
+	EXPECT_EQ(it.get_size(), 120);
+}
+
+TEST(NDIter, LoopsAreReorderedToTheStrideOrder) {
+	// Both operands are column-major views of a 3 x 4 shape: walking them in stride order makes them dense.
+	std::vector<size_t> shape({ 3, 4 });
+	NDIter::Iterator<2> it(shape, { std::vector<ptrdiff_t>({ 1, 3 }), std::vector<ptrdiff_t>({ 1, 3 }) });
+	EXPECT_EQ(it.get_shape(), std::vector<size_t>({ 12 }));
+	EXPECT_TRUE(it.inner_contiguous());
+}
+
+TEST(NDIter, PermutedOperandKeepsTheAdjacentAxesMerged) {
+	// dst[b][i][j] = src[i][b][j]: the j axis stays contiguous in both, b and i do not merge.
+	std::vector<size_t> shape({ 2, 3, 4 });
+	NDIter::Iterator<2> it(shape, { NDIter::dense_strides(shape), std::vector<ptrdiff_t>({ 4, 8, 1 }) });
+	EXPECT_EQ(it.get_shape(), std::vector<size_t>({ 2, 3, 4 }));
+	EXPECT_TRUE(it.inner_contiguous());
+
+	// Broadcasting along the outer axes merges them too: stride 0 is 0 whatever the extent.
+	NDIter::Iterator<2> broadcast(shape, { NDIter::dense_strides(shape), std::vector<ptrdiff_t>({ 0, 0, 1 }) });
+	EXPECT_EQ(broadcast.get_shape(), std::vector<size_t>({ 6, 4 }));
+}
+
+// ============== Elementwise Kernels ==================
+TEST(NDIter, TransformWithBroadcastAndReversedOperands) {
+	// out[i][j] = a[i][j] + b[j] + c[i][3 - j]
+	std::vector<size_t> shape({ 3, 4 });
+	std::vector<double> a(12), b({ 100, 200, 300, 400 }), c(12), out(12);
+	for (size_t i = 0; i < 12; ++i) {
+		a[i] = static_cast<double>(i);
+		c[i] = static_cast<double>(i) * 0.5;
+	}
+
+	NDIter::Iterator<4> it(shape, { NDIter::dense_strides(shape), NDIter::dense_strides(shape),
+		std::vector<ptrdiff_t>({ 0, 1 }), std::vector<ptrdiff_t>({ 4, -1 }) });
+	NDIter::transform(it, [](double x, double y, double z) { return x + y + z; }, out.data(), a.data(), b.data(), c.data() + 3);
+
+	for (size_t i = 0; i < 3; ++i) {
+		for (size_t j = 0; j < 4; ++j) {
+			EXPECT_EQ(out[i * 4 + j], a[i * 4 + j] + b[j] + c[i * 4 + 3 - j]);
+		}
+	}
+}
+
+TEST(NDIter, EmptyShapesRunNothing) {
+	std::vector<size_t> shape({ 3, 0, 2 });
+	NDIter::Iterator<1> it(shape, { NDIter::dense_strides(shape) });
+	size_t calls = 0;
+	it.for_each_chunk([&calls](size_t, const std::array<ptrdiff_t, 1>&, double*) { ++calls; }, static_cast<double*>(nullptr));
+	EXPECT_EQ(calls, 0);
+}
+
+TEST(NDIter, ParallelChunksCoverEveryElementOnce) {
+	// 64 x 3 x 700 with the middle axis moved outermost in the source: a large, non-trivial loop nest.
+	std::vector<size_t> shape({ 64, 3, 700 });
+	std::vector<int> src(64 * 3 * 700), serial(src.size()), parallel(src.size());
+	for (size_t i = 0; i < src.size(); ++i) {
+		src[i] = static_cast<int>(i);
+	}
+	std::array<std::vector<ptrdiff_t>, 2> strides({ NDIter::dense_strides(shape), std::vector<ptrdiff_t>({ 700, 64 * 700, 1 }) });
+	NDIter::Iterator<2> it(shape, strides);
+	{
+		NDParallel::ThreadScope scope(1);
+		NDIter::transform(it, [](int x) { return x; }, serial.data(), src.data());
+	}
+	{
+		NDParallel::ThreadScope scope(4);
+		NDIter::transform(it, [](int x) { return x; }, parallel.data(), src.data());
+	}
+	EXPECT_EQ(serial, parallel);
+	for (size_t b = 0; b < 64; ++b) {
+		for (size_t i = 0; i < 3; ++i) {
+			EXPECT_EQ(serial[(b * 3 + i) * 700 + 17], src[(i * 64 + b) * 700 + 17]);
+		}
+	}
+}
+
+TEST(NDIter, BatchPermuteMatchesElementwiseIndexing) {
+	NDArray<int> arr({ 5, 6, 7 });
+	std::vector<int> data(5 * 6 * 7);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<int>(i * 3);
+	}
+	arr.set_data(data);
+
+	NDArray<int> res = arr.permute({ 1, 0, 2 });
+	const NDArray<int>& view = arr;
+	for (size_t i = 0; i < 5; ++i) {
+		for (size_t j = 0; j < 6; ++j) {
+			for (size_t k = 0; k < 7; ++k) {
+				EXPECT_EQ(std::as_const(res)({ j, i, k }), view({ i, j, k }));
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "Reduction.hpp"
+#include "ThreadPool.hpp"
+#include "NDArray.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Values of wildly different magnitudes whose exact sum is known: big + small - big, repeated.
+static std::vector<double> make_cancelling_data(size_t repeats) {
+	std::vector<double> data;
+	for (size_t i = 0; i < repeats; ++i) {
+		data.insert(data.end(), { 1e16, 1.0, -1e16, 0.5 });
+	}
+	return data;
+}
+
+// ============== Accuracy ==================
+TEST(ReductionAccuracy, ReproducibleRecoversCancelledTerms) {
+	std::vector<double> data = make_cancelling_data(100000);
+	EXPECT_EQ(NDReduction::sum(data.data(), data.size()), 1.5 * 100000);
+}
+
+TEST(ReductionAccuracy, FloatIsAccumulatedInDouble) {
+	std::vector<float> data(10000000, 0.1f);
+	double exact = 10000000 * static_cast<double>(0.1f);
+
+	float naive = 0.0f;
+	for (float x : data) {
+		naive += x;
+	}
+	float fast = NDReduction::sum(data.data(), data.size(), NDReduction::Mode::Fast);
+	float reproducible = NDReduction::sum(data.data(), data.size(), NDReduction::Mode::Reproducible);
+
+	EXPECT_GT(std::abs(naive - exact) / exact, 1e-2);
+	EXPECT_NEAR(fast, exact, exact * 1e-7);
+	EXPECT_NEAR(reproducible, exact, exact * 1e-7);
+}
+
+TEST(ReductionAccuracy, FastPairwiseBeatsNaive) {
+	std::vector<double> data(1 << 22);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = 1.0 + std::sin(static_cast<double>(i)) * 1e-3;
+	}
+	double reference = NDReduction::sum(data.data(), data.size(), NDReduction::Mode::Reproducible);
+	double naive = 0.0;
+	for (double x : data) {
+		naive += x;
+	}
+	double fast = NDReduction::sum(data.data(), data.size(), NDReduction::Mode::Fast);
+	EXPECT_LE(std::abs(fast - reference), std::abs(naive - reference));
+	EXPECT_NEAR(fast, reference, 1e-9);
+}
+
+TEST(ReductionAccuracy, IntegersAndEdgeCases) {
+	std::vector<int64_t> data(100003);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<int64_t>(i);
+	}
+	EXPECT_EQ(NDReduction::sum(data.data(), data.size()), int64_t(100002) * 100003 / 2);
+	EXPECT_EQ(NDReduction::sum(data.data(), 0), 0);
+	EXPECT_EQ(NDReduction::sum(data.data() + 5, 3), 5 + 6 + 7);
+
+	std::vector<double> few({ 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0 });
+	for (size_t n = 0; n <= few.size(); ++n) {
+		double expected = static_cast<double>(n * (n + 1) / 2);
+		EXPECT_EQ(NDReduction::sum(few.data(), n, NDReduction::Mode::Fast), expected);
+		EXPECT_EQ(NDReduction::sum(few.data(), n, NDReduction::Mode::Reproducible), expected);
+	}
+}
+
+// ============== Reproducibility ==================
+TEST(ReductionReproducibility, BitIdenticalAcrossThreadCounts) {
+	std::vector<double> data(3000017);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = std::sin(static_cast<double>(i) * 0.7) * std::pow(10.0, static_cast<double>(i % 17) - 8.0);
+	}
+
+	double reference;
+	{
+		NDParallel::ThreadScope scope(1);
+		reference = NDReduction::sum(data.data(), data.size());
+	}
+	for (size_t threads : { 2, 3, 4, 7, 16 }) {
+		NDParallel::ThreadScope scope(threads);
+		EXPECT_EQ(NDReduction::sum(data.data(), data.size()), reference);
+	}
+}
+
+TEST(ReductionReproducibility, TransformSumMatchesMaterializedSum) {
+	std::vector<double> a(200000), b(200000), squared(200000);
+	for (size_t i = 0; i < a.size(); ++i) {
+		a[i] = std::cos(static_cast<double>(i));
+		b[i] = std::sin(static_cast<double>(i));
+		squared[i] = (a[i] - b[i]) * (a[i] - b[i]);
+	}
+	double fused = NDReduction::transform_sum<double>(a.size(), [&](size_t i) { return (a[i] - b[i]) * (a[i] - b[i]); });
+	EXPECT_EQ(fused, NDReduction::sum(squared.data(), squared.size()));
+}
+
+TEST(ReductionReproducibility, NDArraySumUsesTheEngine) {
+	NDArray<double> arr({ 4, 100000 });
+	arr.set_data(make_cancelling_data(100000));
+	const NDArray<double>& view = arr;
+	EXPECT_EQ(view.sum(), 1.5 * 100000);
+
+	// Fast mode makes no accuracy promise on this input, but it must be the engine's own fast sum.
+	EXPECT_EQ(view.sum(NDReduction::Mode::Fast),
+		NDReduction::sum(view.get_data().data(), view.get_data().size(), NDReduction::Mode::Fast));
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "BWMLLib/StandardScaler.h"
+#include "BWMLLib/LinReg.h"
+#include "ThreadPool.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Two features on very different scales around a large offset: x0 ~ 1e6 + [0, 1000), x1 ~ [0, 1).
+static NDArray<double> make_unscaled_data(size_t m) {
+	std::vector<double> data;
+	for (size_t i = 0; i < m; ++i) {
+		data.push_back(1e6 + static_cast<double>((i * 37) % 1000));
+		data.push_back(static_cast<double>((i * 11) % 100) / 100.0);
+	}
+	NDArray<double> X({ m, 2 });
+	X.set_data(std::move(data));
+	return X;
+}
+
+// ============== StandardScaler Fitting ==================
+TEST(StandardScalerFit, MatchesTwoPassStatistics) {
+	NDArray<double> X = make_unscaled_data(5000);
+	const std::vector<double>& x = std::as_const(X).get_data();
+
+	BWMLLib::StandardScaler scaler;
+	scaler.fit(X);
+
+	for (size_t j = 0; j < 2; ++j) {
+		double mean = 0.0;
+		for (size_t i = 0; i < 5000; ++i) {
+			mean += x[i * 2 + j];
+		}
+		mean /= 5000;
+		double variance = 0.0;
+		for (size_t i = 0; i < 5000; ++i) {
+			variance += (x[i * 2 + j] - mean) * (x[i * 2 + j] - mean);
+		}
+		variance /= 5000;
+
+		EXPECT_NEAR(scaler.get_mean().get_data()[j], mean, 1e-9 * std::abs(mean));
+		EXPECT_NEAR(scaler.get_variance().get_data()[j], variance, 1e-9 * variance);
+	}
+	EXPECT_EQ(scaler.get_n_samples_seen(), 5000);
+}
+
+TEST(StandardScalerFit, PartialFitMatchesFit) {
+	NDArray<double> X = make_unscaled_data(3001);
+	const std::vector<double>& x = std::as_const(X).get_data();
+
+	BWMLLib::StandardScaler whole;
+	whole.fit(X);
+
+	BWMLLib::StandardScaler streamed;
+	for (size_t begin = 0; begin < 3001; begin += 700) {
+		size_t rows = std::min<size_t>(700, 3001 - begin);
+		NDArray<double> chunk({ rows, 2 });
+		chunk.set_data(std::vector<double>(x.begin() + begin * 2, x.begin() + (begin + rows) * 2));
+		streamed.partial_fit(chunk);
+	}
+
+	EXPECT_EQ(streamed.get_n_samples_seen(), 3001);
+	for (size_t j = 0; j < 2; ++j) {
+		EXPECT_NEAR(streamed.get_mean().get_data()[j], whole.get_mean().get_data()[j], 1e-6);
+		EXPECT_NEAR(streamed.get_variance().get_data()[j], whole.get_variance().get_data()[j], 1e-6);
+	}
+}
+
+TEST(StandardScalerFit, IndependentOfThreadCount) {
+	NDArray<double> X = make_unscaled_data(200000);
+
+	BWMLLib::StandardScaler serial, parallel;
+	{
+		NDParallel::ThreadScope scope(1);
+		serial.fit(X);
+	}
+	{
+		NDParallel::ThreadScope scope(4);
+		parallel.fit(X);
+	}
+	EXPECT_EQ(serial.get_mean(), parallel.get_mean());
+	EXPECT_EQ(serial.get_variance(), parallel.get_variance());
+}
+
+TEST(StandardScalerFit, FeatureCountMismatch) {
+	BWMLLib::StandardScaler scaler;
+	scaler.partial_fit(NDArray<double>({ 4, 2 }));
+	EXPECT_THROW(scaler.partial_fit(NDArray<double>({ 4, 3 })), std::invalid_argument);
+
+	NDArray<double> wrong({ 4, 3 });
+	EXPECT_THROW(scaler.transform(wrong), std::invalid_argument);
+}
+
+// ============== StandardScaler Transform ==================
+TEST(StandardScalerTransform, StandardizesInPlace) {
+	NDArray<double> X = make_unscaled_data(1000);
+
+	BWMLLib::StandardScaler scaler;
+	scaler.fit_transform(X);
+
+	BWMLLib::StandardScaler check;
+	check.fit(X);
+	for (size_t j = 0; j < 2; ++j) {
+		EXPECT_NEAR(check.get_mean().get_data()[j], 0.0, 1e-9);
+		EXPECT_NEAR(check.get_variance().get_data()[j], 1.0, 1e-9);
+	}
+}
+
+TEST(StandardScalerTransform, InverseTransformRoundTrip) {
+	NDArray<double> X = make_unscaled_data(100);
+	NDArray<double> original = X;
+
+	BWMLLib::StandardScaler scaler;
+	scaler.fit_transform(X);
+	scaler.inverse_transform(X);
+
+	for (size_t i = 0; i < 200; ++i) {
+		EXPECT_NEAR(std::as_const(X).get_data()[i], std::as_const(original).get_data()[i], 1e-6);
+	}
+}
+
+TEST(StandardScalerTransform, ConstantFeatureIsNotScaled) {
+	NDArray<double> X({ 3, 1 });
+	X.set_data({ 5.0, 5.0, 5.0 });
+
+	BWMLLib::StandardScaler scaler;
+	scaler.fit_transform(X);
+	EXPECT_EQ(std::as_const(X).get_data(), std::vector<double>({ 0.0, 0.0, 0.0 }));
+}
+
+TEST(StandardScalerTransform, UnfittedScalerThrows) {
+	BWMLLib::StandardScaler scaler;
+	NDArray<double> X({ 2, 2 });
+	EXPECT_THROW(scaler.transform(X), std::logic_error);
+}
+
+TEST(StandardScalerTransform, SpeedsUpLinRegConvergence) {
+	NDArray<double> X = make_unscaled_data(500);
+	NDArray<double> y({ 500 });
+	for (size_t i = 0; i < 500; ++i) {
+		const std::vector<double>& x = std::as_const(X).get_data();
+		y.get_data()[i] = 0.01 * (x[i * 2] - 1e6) + 20.0 * x[i * 2 + 1];
+	}
+	NDArray<double> X_raw = X;
+	NDArray<double> y_raw = y;
+	NDArray<double> y_copy = y;
+	NDArray<double> X_test = make_unscaled_data(500);
+	NDArray<double> X_test_raw = X_test;
+
+	auto mean_squared_error = [&](const NDArray<double>& predictions) {
+		double mse = 0.0;
+		for (size_t i = 0; i < 500; ++i) {
+			double residual = predictions.get_data()[i] - std::as_const(y_copy).get_data()[i];
+			mse += residual * residual / 500;
+		}
+		return mse;
+	};
+
+	// The same model and budget on the raw features: a step size that suits the standardized data overshoots
+	// along x0 ~ 1e6 and gradient descent blows up.
+	BWMLLib::LinReg raw_model(0.5, 1e-12);
+	raw_model.set_verbose(false);
+	raw_model.fit(X_raw, y_raw, 2000);
+	double raw_mse = mean_squared_error(raw_model.predict(X_test_raw));
+
+	BWMLLib::StandardScaler scaler;
+	scaler.fit_transform(X);
+	BWMLLib::LinReg model(0.5, 1e-12);
+	model.set_verbose(false);
+	model.fit(X, y, 2000);
+	scaler.transform(X_test);
+	double scaled_mse = mean_squared_error(model.predict(X_test));
+
+	EXPECT_LT(scaled_mse, 1e-6);
+	EXPECT_TRUE(!std::isfinite(raw_mse) || raw_mse > 1e6 * scaled_mse) << "raw mse: " << raw_mse;
+}
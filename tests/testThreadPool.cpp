@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "ThreadPool.hpp"
+#include "NDArray.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============== Thread Count ==================
+TEST(ThreadCount, ScopeOverridesGlobal) {
+	NDParallel::set_num_threads(3);
+	EXPECT_EQ(NDParallel::get_num_threads(), 3);
+	{
+		NDParallel::ThreadScope scope(1);
+		EXPECT_EQ(NDParallel::get_num_threads(), 1);
+		{
+			NDParallel::ThreadScope inner(5);
+			EXPECT_EQ(NDParallel::get_num_threads(), 5);
+		}
+		EXPECT_EQ(NDParallel::get_num_threads(), 1);
+	}
+	EXPECT_EQ(NDParallel::get_num_threads(), 3);
+	NDParallel::set_num_threads(0);
+	EXPECT_EQ(NDParallel::get_num_threads(), std::max<size_t>(1, std::thread::hardware_concurrency()));
+}
+
+// ============== Parallel Loops ==================
+TEST(ParallelFor, CoversRangeExactlyOnce) {
+	NDParallel::ThreadScope scope(4);
+	std::vector<std::atomic<int>> hits(10007);
+	NDParallel::parallel_for(0, hits.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			hits[i].fetch_add(1);
+		}
+	}, 16);
+
+	for (const std::atomic<int>& hit : hits) {
+		EXPECT_EQ(hit.load(), 1);
+	}
+}
+
+TEST(ParallelFor, SmallRangesStaySerial) {
+	NDParallel::ThreadScope scope(4);
+	size_t calls = 0;
+	NDParallel::parallel_for(0, 100, [&](size_t begin, size_t end) {
+		++calls;
+		EXPECT_EQ(begin, 0);
+		EXPECT_EQ(end, 100);
+	}, 64);
+	EXPECT_EQ(calls, 1);
+}
+
+TEST(ParallelFor, NestedRegionsRunSerially) {
+	NDParallel::ThreadScope scope(4);
+	std::atomic<size_t> inner_calls{ 0 };
+	NDParallel::parallel_for(0, 8, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			NDParallel::parallel_for(0, 1000, [&](size_t, size_t) { inner_calls.fetch_add(1); }, 1);
+		}
+	}, 1);
+	EXPECT_EQ(inner_calls.load(), 8);
+}
+
+TEST(ParallelFor, PropagatesExceptions) {
+	NDParallel::ThreadScope scope(4);
+	EXPECT_THROW(NDParallel::parallel_for(0, 1000, [](size_t begin, size_t) {
+		if (begin != 0) {
+			throw std::runtime_error("chunk failed");
+		}
+	}, 10), std::runtime_error);
+}
+
+TEST(ParallelReduce, IndependentOfThreadCount) {
+	std::vector<double> values(100003);
+	for (size_t i = 0; i < values.size(); ++i) {
+		values[i] = 1.0 / static_cast<double>(i + 1);
+	}
+	auto reduce = [&](size_t n_threads) {
+		NDParallel::ThreadScope scope(n_threads);
+		return NDParallel::parallel_reduce(size_t(0), values.size(), 0.0,
+			[&](size_t begin, size_t end) {
+				double s = 0.0;
+				for (size_t i = begin; i < end; ++i) {
+					s += values[i];
+				}
+				return s;
+			},
+			[](double a, double b) { return a + b; }, 1000);
+	};
+
+	double serial = reduce(1);
+	EXPECT_EQ(serial, reduce(2));
+	EXPECT_EQ(serial, reduce(7));
+}
+
+TEST(ParallelReduce, FixedPairwiseTree) {
+	auto reduce = [](size_t n_threads) {
+		NDParallel::ThreadScope scope(n_threads);
+		return NDParallel::parallel_reduce(size_t(0), size_t(7), std::string(),
+			[](size_t begin, size_t) { return std::to_string(begin); },
+			[](const std::string& a, const std::string& b) { return "(" + a + "," + b + ")"; }, 1);
+	};
+
+	// Mapped in waves of one block per thread, folded into the same tree.
+	for (size_t n_threads : { 1, 2, 3, 8 }) {
+		EXPECT_EQ(reduce(n_threads), "(((0,1),(2,3)),((4,5),6))");
+	}
+}
+
+// ============== Parallel NDArray Ops ==================
+TEST(ParallelNDArray, ElementwiseAndSumMatchSerial) {
+	NDArray<double> a({ 300, 400 });
+	NDArray<double> b({ 300, 400 });
+	for (size_t i = 0; i < a.get_data().size(); ++i) {
+		a.get_data()[i] = static_cast<double>(i % 97);
+		b.get_data()[i] = static_cast<double>(i % 13) + 1.0;
+	}
+
+	NDArray<double> serial_sum, parallel_sum;
+	double serial_total, parallel_total;
+	{
+		NDParallel::ThreadScope scope(1);
+		serial_sum = ((a + b) * 2.0 - b).square().square_root() / 3.0;
+		serial_total = serial_sum.sum();
+	}
+	{
+		NDParallel::ThreadScope scope(4);
+		parallel_sum = ((a + b) * 2.0 - b).square().square_root() / 3.0;
+		parallel_total = parallel_sum.sum();
+	}
+	EXPECT_EQ(serial_sum, parallel_sum);
+	EXPECT_EQ(serial_total, parallel_total);
+}
+
+TEST(ParallelNDArray, MatmulMatchesSerial) {
+	NDArray<int> a({ 4, 64, 48 });
+	NDArray<int> b({ 4, 48, 80 });
+	for (size_t i = 0; i < a.get_data().size(); ++i) {
+		a.get_data()[i] = static_cast<int>(i % 7) - 3;
+	}
+	for (size_t i = 0; i < b.get_data().size(); ++i) {
+		b.get_data()[i] = static_cast<int>(i % 5) - 2;
+	}
+
+	NDArray<int> serial, parallel;
+	{
+		NDParallel::ThreadScope scope(1);
+		serial = a.batched_matmul(b);
+	}
+	{
+		NDParallel::ThreadScope scope(4);
+		parallel = a.batched_matmul(b);
+	}
+	EXPECT_EQ(serial, parallel);
+	EXPECT_EQ(serial.get_shape(), std::vector<size_t>({ 4, 64, 80 }));
+}